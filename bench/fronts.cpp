@@ -0,0 +1,189 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ *
+ * Cross-check of the incremental non-domination levels the steady state keeps. Random points are inserted and a member of the last front
+ * removed, as insert_offspring does, and after every change the ranks are compared to a full non-dominated sort of the same points.
+ */
+#include <objectives.h>
+#include <blt/parse/argparse.h>
+#include <blt/std/logging.h>
+#include <blt/std/format.h>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+struct check_config
+{
+    size_t objectives;
+    // values drawn from a handful of integers so points share objective values and whole vectors
+    bool ties;
+};
+
+struct check_result
+{
+    std::uint64_t changes = 0;
+    std::uint64_t mismatches = 0;
+    size_t max_fronts = 0;
+};
+
+class fronts_check
+{
+    public:
+        fronts_check(check_config config, size_t size, std::uint64_t seed): config(config), engine(seed)
+        {
+            for (size_t i = 0; i < size; i++)
+                add_point();
+            full_sort();
+            fronts.assign(matrix, expected);
+        }
+
+        check_result run(std::uint64_t pairs)
+        {
+            check_result result;
+            std::vector<double> point(config.objectives);
+            for (std::uint64_t i = 0; i < pairs; i++)
+            {
+                for (auto& v : point)
+                    v = draw();
+                points.insert(points.end(), point.begin(), point.end());
+                fronts.insert(point.data(), ranks);
+                compare(result);
+
+                const auto& last = fronts.last_front();
+                const auto id = last[std::uniform_int_distribution<size_t>(0, last.size() - 1)(engine)];
+                fronts.remove(id, ranks);
+                // the highest id takes the removed one's place, the caller's points move the same way
+                const auto k = config.objectives;
+                const auto moved = points.size() / k - 1;
+                if (id != moved)
+                    std::copy_n(points.begin() + static_cast<std::ptrdiff_t>(moved * k), k, points.begin() + static_cast<std::ptrdiff_t>(id * k));
+                points.resize(moved * k);
+                compare(result);
+            }
+            return result;
+        }
+
+    private:
+        double draw()
+        {
+            if (config.ties)
+                return static_cast<double>(std::uniform_int_distribution<int>(0, 9)(engine));
+            return std::uniform_real_distribution<double>(0, 1)(engine);
+        }
+
+        void add_point()
+        {
+            for (size_t j = 0; j < config.objectives; j++)
+                points.push_back(draw());
+        }
+
+        void full_sort()
+        {
+            const auto k = config.objectives;
+            const auto n = points.size() / k;
+            matrix.reset(k, n);
+            for (size_t j = 0; j < k; j++)
+            {
+                auto* column = matrix.column(j);
+                for (size_t i = 0; i < n; i++)
+                    column[i] = points[i * k + j];
+            }
+            sorter.sort(matrix, expected);
+            if (ranks.empty())
+                ranks = expected;
+        }
+
+        void compare(check_result& result)
+        {
+            full_sort();
+            result.changes++;
+            const auto fronts_expected = static_cast<size_t>(*std::max_element(expected.begin(), expected.end()));
+            result.max_fronts = std::max(result.max_fronts, fronts_expected);
+            if (ranks == expected && fronts.front_count() == fronts_expected && fronts.size() == expected.size())
+                return;
+            if (result.mismatches++ == 0)
+                BLT_ERROR("Ranks differ from a full sort after change %lu (%lu objectives%s)", result.changes, config.objectives,
+                          config.ties ? ", ties" : "");
+            // carry on from the correct levels so one error is not counted at every later change
+            fronts.assign(matrix, expected);
+            ranks = expected;
+        }
+
+        check_config config;
+        std::mt19937_64 engine;
+        std::vector<double> points;
+        ga::objective_matrix matrix;
+        ga::non_dominated_sorter sorter;
+        ga::incremental_fronts fronts;
+        std::vector<ga::rank_t> ranks, expected;
+};
+
+int main(int argc, const char** argv)
+{
+    blt::arg_parse parser;
+
+    parser.addArgument(blt::arg_builder("--seed", "-s").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("Seed for the random points. (Default: 691)")
+                                                       .setDefault("691").build());
+    parser.addArgument(blt::arg_builder("--pairs", "-n").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                        .setHelp("Insert/remove pairs over all configurations, split evenly. (Default: 60000)")
+                                                        .setDefault("60000").build());
+    parser.addArgument(blt::arg_builder("--size").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                 .setHelp("Points kept between changes, the population size. (Default: 100)")
+                                                 .setDefault("100").build());
+
+    auto args = parser.parse_args(argc, argv);
+
+    std::uint64_t seed, pairs;
+    size_t size;
+    try
+    {
+        seed = std::stoull(args.get<std::string>("seed"));
+        pairs = std::stoull(args.get<std::string>("pairs"));
+        size = std::stoull(args.get<std::string>("size"));
+    } catch (const std::exception&)
+    {
+        BLT_ERROR("--seed, --pairs and --size must be whole numbers");
+        return 1;
+    }
+    if (size == 0)
+    {
+        BLT_ERROR("--size must be at least 1");
+        return 1;
+    }
+
+    const std::vector<check_config> configs{{2, false}, {2, true}, {3, false}, {3, true}, {4, false}, {4, true}};
+
+    blt::string::TableFormatter formatter{"Incremental Fronts Cross-check (seed " + std::to_string(seed) + ")"};
+    formatter.addColumn({"Objectives"});
+    formatter.addColumn({"Ties"});
+    formatter.addColumn({"Changes"});
+    formatter.addColumn({"Most fronts"});
+    formatter.addColumn({"Mismatches"});
+
+    std::uint64_t mismatches = 0;
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        const auto& config = configs[i];
+        fronts_check check(config, size, seed + i);
+        const auto result = check.run(pairs / configs.size());
+        mismatches += result.mismatches;
+        formatter.addRow({std::to_string(config.objectives), config.ties ? "yes" : "no", std::to_string(result.changes),
+                          std::to_string(result.max_fronts), std::to_string(result.mismatches)});
+    }
+
+    for (const auto& v : formatter.createTable(true, true))
+        std::cout << v << "\n";
+    std::cout.flush();
+
+    if (mismatches > 0)
+    {
+        BLT_ERROR("%lu changes left the incremental fronts out of step with a full sort", mismatches);
+        return 1;
+    }
+    BLT_INFO("Every change matched a full sort");
+    return 0;
+}
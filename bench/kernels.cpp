@@ -0,0 +1,348 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ *
+ * Micro-benchmarks for the GA kernels. Every instance is run from the same seed so two builds can be compared op for op.
+ */
+#include <program.h>
+#include <loader.h>
+#include <blt/parse/argparse.h>
+#include <blt/std/logging.h>
+#include <blt/std/format.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+
+static std::atomic<std::uint64_t> allocations{0};
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+namespace ga
+{
+    // forwards to the private kernels of the program
+    struct kernel_access
+    {
+        program& p;
+
+        double distance(customerID_t c1, customerID_t c2)
+        {
+            return p.distance(c1, c2);
+        }
+
+        bool validate_route(const route& r)
+        {
+            return p.validate_route(r);
+        }
+
+        double calculate_distance(const route& r)
+        {
+            return p.calculate_distance(r);
+        }
+
+        std::vector<route> constructRoute(const chromosome& c)
+        {
+            return p.constructRoute(c);
+        }
+
+        void remove_from(const route& r, individual& c)
+        {
+            program::remove_from(r, c);
+        }
+
+        void insert_to(const route& r, individual& c)
+        {
+            p.insert_to(r, c);
+        }
+
+        customerID_t select_pop()
+        {
+            return p.select_pop<pareto_objective>(p.TOURNAMENT_SIZE);
+        }
+
+        void evaluate()
+        {
+            p.reconstruct_populations();
+            p.calculatePopulationFitness();
+            p.rankPopulation<pareto_objective>();
+        }
+
+        void rankPopulation()
+        {
+            p.rankPopulation<pareto_objective>();
+        }
+
+        void rankWeightedSum()
+        {
+            p.rankPopulation<weighted_sum_objective>();
+        }
+
+        population& pop()
+        {
+            return p.current_population;
+        }
+    };
+}
+
+struct kernel_result
+{
+    std::string kernel;
+    std::uint64_t ops = 0;
+    double ns_per_op = 0;
+    double allocs_per_op = 0;
+};
+
+/**
+ * Runs the batch until the time budget is spent, the batch returns how many ops it performed.
+ */
+kernel_result measure(const std::string& name, std::chrono::milliseconds budget, const std::function<std::uint64_t()>& batch)
+{
+    // warm up caches and the branch predictors
+    batch();
+
+    kernel_result result{name};
+    std::uint64_t total_ns = 0;
+    std::uint64_t total_allocs = 0;
+    const auto budget_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(budget).count());
+    while (total_ns < budget_ns)
+    {
+        auto allocs_start = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        result.ops += batch();
+        auto end = std::chrono::steady_clock::now();
+        total_allocs += allocations.load(std::memory_order_relaxed) - allocs_start;
+        total_ns += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    result.ns_per_op = static_cast<double>(total_ns) / static_cast<double>(result.ops);
+    result.allocs_per_op = static_cast<double>(total_allocs) / static_cast<double>(result.ops);
+    return result;
+}
+
+std::vector<kernel_result> run_instance(const std::string& path, std::uint64_t seed, std::chrono::milliseconds budget)
+{
+    std::vector<kernel_result> results;
+
+    ga::program p(solomon_capacity(path), load_problem(path), ga::objective_mode::PARETO, ga::DEFAULT_POPULATION_SIZE, ga::DEFAULT_GENERATION_COUNT,
+                  ga::DEFAULT_TOURNAMENT_SIZE, ga::DEFAULT_ELITE_COUNT, ga::DEFAULT_CROSSOVER_RATE, ga::DEFAULT_MUTATION_RATE,
+                  ga::DEFAULT_MUTATION_2_RATE, seed);
+    ga::kernel_access k{p};
+    k.evaluate();
+
+    // inputs are drawn once so every kernel sees the same work on every build
+    ga::random_engine engine(seed);
+    std::vector<std::pair<ga::customerID_t, ga::customerID_t>> pairs;
+    for (int i = 0; i < 1024; i++)
+        pairs.emplace_back(engine.getInt(0, ga::CUSTOMER_COUNT), engine.getInt(0, ga::CUSTOMER_COUNT));
+
+    std::vector<ga::route> routes;
+    for (const auto& indv : k.pop().pops)
+        for (const auto& r : indv.routes)
+            routes.push_back(r);
+
+    std::vector<ga::chromosome> chromosomes;
+    for (const auto& indv : k.pop().pops)
+        chromosomes.push_back(indv.c);
+
+    results.push_back(measure("distance", budget, [&]() -> std::uint64_t {
+        double d = 0;
+        for (const auto& [c1, c2] : pairs)
+            d += k.distance(c1, c2);
+        do_not_optimize(d);
+        return pairs.size();
+    }));
+
+    results.push_back(measure("validate_route", budget, [&]() -> std::uint64_t {
+        size_t valid = 0;
+        for (const auto& r : routes)
+            valid += k.validate_route(r);
+        do_not_optimize(valid);
+        return routes.size();
+    }));
+
+    results.push_back(measure("calculate_distance", budget, [&]() -> std::uint64_t {
+        double d = 0;
+        for (const auto& r : routes)
+            d += k.calculate_distance(r);
+        do_not_optimize(d);
+        return routes.size();
+    }));
+
+    results.push_back(measure("constructRoute", budget, [&]() -> std::uint64_t {
+        for (size_t i = 0; i < 16; i++)
+        {
+            auto r = k.constructRoute(chromosomes[i % chromosomes.size()]);
+            do_not_optimize(r);
+        }
+        return 16;
+    }));
+
+    {
+        // insert_to always receives an individual with a route already taken out, build those outside the timed region
+        const auto& pops = k.pop().pops;
+        std::vector<std::pair<ga::route, ga::individual>> removed;
+        for (size_t i = 0; i < 16; i++)
+        {
+            const auto& donor = pops[(i * 7) % pops.size()];
+            auto target = pops[(i * 13 + 1) % pops.size()];
+            const auto& r = donor.routes[i % donor.routes.size()];
+            k.remove_from(r, target);
+            removed.emplace_back(r, std::move(target));
+        }
+        std::vector<ga::individual> working;
+        working.reserve(removed.size());
+        results.push_back(measure("insert_to", budget, [&]() -> std::uint64_t {
+            auto allocs_before = allocations.load(std::memory_order_relaxed);
+            working.clear();
+            for (const auto& v : removed)
+                working.push_back(v.second);
+            // the copies belong to the setup, not the kernel
+            allocations.store(allocs_before, std::memory_order_relaxed);
+            for (size_t i = 0; i < removed.size(); i++)
+                k.insert_to(removed[i].first, working[i]);
+            do_not_optimize(working);
+            return removed.size();
+        }));
+    }
+
+    results.push_back(measure("rankPopulation", budget, [&]() -> std::uint64_t {
+        k.rankPopulation();
+        return 1;
+    }));
+
+    results.push_back(measure("select_pop", budget, [&]() -> std::uint64_t {
+        std::int64_t sum = 0;
+        for (int i = 0; i < 1024; i++)
+            sum += k.select_pop();
+        do_not_optimize(sum);
+        return 1024;
+    }));
+
+    // the last two population kernels leave the population ranked on something else
+    results.push_back(measure("rankPopulation weighted_sum", budget, [&]() -> std::uint64_t {
+        k.rankWeightedSum();
+        return 1;
+    }));
+
+    p.setParetoObjectives({ga::objective_id::VEHICLES, ga::objective_id::DISTANCE, ga::objective_id::WAITING, ga::objective_id::IMBALANCE});
+    results.push_back(measure("rankPopulation 4 objectives", budget, [&]() -> std::uint64_t {
+        k.rankPopulation();
+        return 1;
+    }));
+
+    {
+        // the step changes the population, so it gets a fresh program from the same seed. The steady state ranks each offspring into the
+        // fronts on its own, compare the rank phase of the two in the step profile
+        ga::program step(solomon_capacity(path), load_problem(path), ga::objective_mode::PARETO, ga::DEFAULT_POPULATION_SIZE, ga::DEFAULT_GENERATION_COUNT,
+                         ga::DEFAULT_TOURNAMENT_SIZE, ga::DEFAULT_ELITE_COUNT, ga::DEFAULT_CROSSOVER_RATE, ga::DEFAULT_MUTATION_RATE,
+                         ga::DEFAULT_MUTATION_2_RATE, seed);
+        step.setStepMode(ga::step_mode::STEADY_STATE);
+        results.push_back(measure("executeStep steady_state", budget, [&]() -> std::uint64_t {
+            step.executeStep();
+            return 1;
+        }));
+    }
+
+    {
+        // the step changes the population, so it gets a fresh program from the same seed
+        ga::program step(solomon_capacity(path), load_problem(path), ga::objective_mode::PARETO, ga::DEFAULT_POPULATION_SIZE, ga::DEFAULT_GENERATION_COUNT,
+                         ga::DEFAULT_TOURNAMENT_SIZE, ga::DEFAULT_ELITE_COUNT, ga::DEFAULT_CROSSOVER_RATE, ga::DEFAULT_MUTATION_RATE,
+                         ga::DEFAULT_MUTATION_2_RATE, seed);
+        results.push_back(measure("executeStep", budget, [&]() -> std::uint64_t {
+            step.executeStep();
+            return 1;
+        }));
+    }
+
+    return results;
+}
+
+int main(int argc, const char** argv)
+{
+    blt::arg_parse parser;
+
+    parser.addArgument(blt::arg_builder("--problems", "-p").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                           .setHelp("Directory of .set instances to benchmark, or a single instance. (Default: ../problems)")
+                                                           .setDefault("../problems").build());
+    parser.addArgument(blt::arg_builder("--seed", "-s").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("Seed used for every program and input. (Default: 691)")
+                                                       .setDefault("691").build());
+    parser.addArgument(blt::arg_builder("--time", "-t").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("Milliseconds spent measuring each kernel. (Default: 250)")
+                                                       .setDefault("250").build());
+    parser.addArgument(blt::arg_builder("--csv", "-o").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                      .setHelp("Also write the results as CSV to this file.")
+                                                      .setDefault("").build());
+
+    auto args = parser.parse_args(argc, argv);
+
+    const auto seed = static_cast<std::uint64_t>(std::stoull(args.get<std::string>("seed")));
+    const std::chrono::milliseconds budget{args.get<int32_t>("time")};
+
+    std::vector<std::string> problems;
+    const std::filesystem::path problem_path = args.get<std::string>("problems");
+    if (std::filesystem::is_directory(problem_path))
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(problem_path))
+            if (entry.path().extension() == ".set")
+                problems.push_back(entry.path().string());
+        std::sort(problems.begin(), problems.end());
+    } else
+        problems.push_back(problem_path.string());
+
+    blt::string::TableFormatter formatter{"Kernel Benchmarks (seed " + std::to_string(seed) + ")"};
+    formatter.addColumn({"Instance"});
+    formatter.addColumn({"Kernel"});
+    formatter.addColumn({"Ops"});
+    formatter.addColumn({"ns/op"});
+    formatter.addColumn({"allocs/op"});
+
+    std::ofstream csv;
+    if (!args.get<std::string>("csv").empty())
+    {
+        csv.open(args.get<std::string>("csv"));
+        csv << "Instance,Kernel,Ops,NsPerOp,AllocsPerOp\n";
+    }
+
+    for (const auto& problem : problems)
+    {
+        BLT_INFO("Benchmarking %s", problem.c_str());
+        const auto instance = std::filesystem::path(problem).stem().string();
+        for (const auto& r : run_instance(problem, seed, budget))
+        {
+            formatter.addRow({instance, r.kernel, std::to_string(r.ops), std::to_string(r.ns_per_op), std::to_string(r.allocs_per_op)});
+            if (csv.is_open())
+                csv << instance << ',' << r.kernel << ',' << r.ops << ',' << r.ns_per_op << ',' << r.allocs_per_op << '\n';
+        }
+    }
+
+    for (const auto& v : formatter.createTable(true, true))
+        std::cout << v << "\n";
+
+    return 0;
+}
@@ -0,0 +1,333 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ *
+ * Quality and speed regression harness. Runs a fixed, seeded configuration over every instance and compares the outcome to a checked in
+ * baseline, flagging changes that are both statistically significant (Welch's t-test) and larger than the metric's tolerance. Timings
+ * depend on the machine and build that recorded them and are only reported. After an intended change in quality, re-baseline from a
+ * Release build with --update 1 and commit bench/baseline.csv.
+ */
+#include <program.h>
+#include <loader.h>
+#include <stats.h>
+#include <blt/parse/argparse.h>
+#include <blt/std/logging.h>
+#include <blt/std/format.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+struct run_result
+{
+    std::uint64_t seed = 0;
+    double seconds = 0;
+    double evals_per_second = 0;
+    ga::individual_point best_cars;
+    ga::individual_point best_distance;
+    std::vector<ga::individual_point> front;
+    double hypervolume = 0;
+    // against the best known solution, NaN when the instance has none
+    double vehicle_gap = std::numeric_limits<double>::quiet_NaN();
+    double distance_gap_percent = std::numeric_limits<double>::quiet_NaN();
+};
+
+struct metric
+{
+    const char* name;
+    // is a smaller value an improvement
+    bool lower_is_better;
+    // change that is allowed before a significant difference counts as a regression
+    double tolerance;
+    // is the tolerance a fraction of the baseline, otherwise it is in the metric's own unit
+    bool relative;
+    // depends on the machine and the build, reported but never a regression
+    bool informational;
+    double (* extract)(const run_result&);
+};
+
+static const std::array<metric, 8> METRICS{
+        metric{"seconds", true, 0.05, true, true, [](const run_result& r) { return r.seconds; }},
+        metric{"evals_per_second", false, 0.05, true, true, [](const run_result& r) { return r.evals_per_second; }},
+        metric{"best_vehicles", true, 0.01, true, false, [](const run_result& r) { return static_cast<double>(r.best_cars.routes); }},
+        metric{"best_vehicles_distance", true, 0.01, true, false, [](const run_result& r) { return r.best_cars.distance; }},
+        metric{"best_distance", true, 0.01, true, false, [](const run_result& r) { return r.best_distance.distance; }},
+        metric{"front_hypervolume", false, 0.01, true, false, [](const run_result& r) { return r.hypervolume; }},
+        // gaps sit around zero where a relative change means nothing, so their tolerances are in vehicles and percentage points
+        metric{"vehicle_gap", true, 0.1, false, false, [](const run_result& r) { return r.vehicle_gap; }},
+        metric{"distance_gap_percent", true, 1, false, false, [](const run_result& r) { return r.distance_gap_percent; }},
+};
+
+struct sample
+{
+    size_t n = 0;
+    double mean = 0;
+    double stddev = 0;
+
+    static sample of(const std::vector<double>& values)
+    {
+        sample s;
+        s.n = values.size();
+        if (s.n == 0)
+            return s;
+        for (auto v : values)
+            s.mean += v;
+        s.mean /= static_cast<double>(s.n);
+        if (s.n > 1)
+        {
+            double sq = 0;
+            for (auto v : values)
+                sq += (v - s.mean) * (v - s.mean);
+            s.stddev = std::sqrt(sq / static_cast<double>(s.n - 1));
+        }
+        return s;
+    }
+};
+
+/**
+ * Welch's t-test for a difference in means. Fixed seeds make the quality metrics deterministic, so two zero variance samples differ
+ * significantly whenever their means differ at all.
+ */
+bool significant(const sample& a, const sample& b)
+{
+    auto va = a.n > 0 ? a.stddev * a.stddev / static_cast<double>(a.n) : 0;
+    auto vb = b.n > 0 ? b.stddev * b.stddev / static_cast<double>(b.n) : 0;
+    auto se = std::sqrt(va + vb);
+    if (se == 0)
+        return a.mean != b.mean;
+    auto t = std::abs(a.mean - b.mean) / se;
+    double df = 1;
+    if (a.n > 1 && b.n > 1)
+        df = (va + vb) * (va + vb) / (va * va / static_cast<double>(a.n - 1) + vb * vb / static_cast<double>(b.n - 1));
+    return t > ga::t_critical(df);
+}
+
+run_result run_once(const std::string& path, std::uint64_t seed, std::int32_t generations)
+{
+    run_result result;
+    result.seed = seed;
+    ga::program p(solomon_capacity(path), load_problem(path), ga::objective_mode::PARETO, ga::DEFAULT_POPULATION_SIZE, generations,
+                  ga::DEFAULT_TOURNAMENT_SIZE, ga::DEFAULT_ELITE_COUNT, ga::DEFAULT_CROSSOVER_RATE, ga::DEFAULT_MUTATION_RATE,
+                  ga::DEFAULT_MUTATION_2_RATE, seed);
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::int32_t i = 0; i < generations; i++)
+        p.executeStep();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    result.evals_per_second = static_cast<double>(p.evaluations()) / result.seconds;
+
+    result.best_cars = p.getBestCars();
+    result.best_distance = p.getBestDistance();
+    result.front = p.getParetoFront();
+    result.hypervolume = p.getHypervolume();
+    return result;
+}
+
+using baseline_t = std::map<std::pair<std::string, std::string>, sample>;
+
+baseline_t load_baseline(const std::string& path)
+{
+    baseline_t baseline;
+    std::ifstream input(path);
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.empty() || line[0] == '#' || line.starts_with("Instance"))
+            continue;
+        std::istringstream stream(line);
+        std::string instance, name, n, mean, stddev;
+        if (!std::getline(stream, instance, ',') || !std::getline(stream, name, ',') || !std::getline(stream, n, ',') ||
+            !std::getline(stream, mean, ',') || !std::getline(stream, stddev, ','))
+            continue;
+        baseline[{instance, name}] = {std::stoul(n), std::stod(mean), std::stod(stddev)};
+    }
+    return baseline;
+}
+
+int main(int argc, const char** argv)
+{
+    blt::arg_parse parser;
+
+    parser.addArgument(blt::arg_builder("--problems", "-p").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                           .setHelp("Directory of .set instances to run. (Default: ../problems)")
+                                                           .setDefault("../problems").build());
+    parser.addArgument(blt::arg_builder("--known", "-k").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                        .setHelp("Best known solutions CSV. (Default: ../problems/best_known.csv)")
+                                                        .setDefault("../problems/best_known.csv").build());
+    parser.addArgument(blt::arg_builder("--baseline", "-b").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                           .setHelp("Baseline to compare against. (Default: ../bench/baseline.csv)")
+                                                           .setDefault("../bench/baseline.csv").build());
+    parser.addArgument(blt::arg_builder("--update", "-u").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                         .setHelp("Set to 1 to overwrite the baseline with this run instead of comparing. Re-baseline "
+                                                                  "from a Release build with the default runs, seed and generations, then "
+                                                                  "commit bench/baseline.csv. (Default: 0)")
+                                                         .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--runs", "-r").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("Seeded runs per instance. (Default: 3)")
+                                                       .setDefault("3").build());
+    parser.addArgument(blt::arg_builder("--seed", "-s").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("Seed of the first run, run i uses seed + i. (Default: 1337)")
+                                                       .setDefault("1337").build());
+    parser.addArgument(blt::arg_builder("--generations", "-g").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                              .setHelp("Generations per run. (Default: 350)")
+                                                              .setDefault(std::to_string(ga::DEFAULT_GENERATION_COUNT)).build());
+    parser.addArgument(blt::arg_builder("--threads", "-t").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                          .setHelp("Instances run in parallel, timings are only comparable at the same count. (Default: 1)")
+                                                          .setDefault("1").build());
+    parser.addArgument(blt::arg_builder("--output", "-o").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                         .setHelp("Prefix of the per run and Pareto front CSVs. (Default: regression)")
+                                                         .setDefault("regression").build());
+
+    auto args = parser.parse_args(argc, argv);
+
+    const auto runs = static_cast<size_t>(args.get<int32_t>("runs"));
+    const auto seed = static_cast<std::uint64_t>(std::stoull(args.get<std::string>("seed")));
+    const auto generations = args.get<int32_t>("generations");
+    const auto thread_count = static_cast<size_t>(std::max(1, args.get<int32_t>("threads")));
+    const auto known = load_best_known(args.get<std::string>("known"));
+#ifndef NDEBUG
+    BLT_WARN("Built without NDEBUG, the timings will not be comparable to a baseline recorded from a Release build");
+#endif
+
+    std::vector<std::string> problems;
+    for (const auto& entry : std::filesystem::directory_iterator(args.get<std::string>("problems")))
+        if (entry.path().extension() == ".set")
+            problems.push_back(entry.path().string());
+    std::sort(problems.begin(), problems.end());
+
+    std::vector<std::vector<run_result>> results(problems.size());
+    std::atomic_size_t next = 0;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; t++)
+    {
+        threads.emplace_back([&]() {
+            for (size_t i = next++; i < problems.size(); i = next++)
+            {
+                BLT_INFO("Running %s", problems[i].c_str());
+                for (size_t r = 0; r < runs; r++)
+                    results[i].push_back(run_once(problems[i], seed + r, generations));
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    const auto prefix = args.get<std::string>("output");
+    std::ofstream run_out(prefix + "_runs.csv");
+    std::ofstream front_out(prefix + "_fronts.csv");
+    run_out << "Instance,Seed,Seconds,EvalsPerSecond,BestVehicles,BestVehiclesDistance,BestDistance,BestDistanceVehicles,FrontSize,"
+               "FrontHypervolume,VehicleGap,DistanceGapPercent\n";
+    front_out << "Instance,Seed,Vehicles,Distance\n";
+
+    baseline_t current;
+    for (size_t i = 0; i < problems.size(); i++)
+    {
+        const auto instance = std::filesystem::path(problems[i]).stem().string();
+        const auto bks = known.find(instance);
+        for (auto& r : results[i])
+        {
+            if (bks != known.end())
+            {
+                r.vehicle_gap = static_cast<double>(r.best_cars.routes) - bks->second.vehicles;
+                r.distance_gap_percent = (r.best_distance.distance - bks->second.distance) / bks->second.distance * 100;
+            }
+            run_out << instance << ',' << r.seed << ',' << r.seconds << ',' << r.evals_per_second << ',' << r.best_cars.routes << ','
+                    << r.best_cars.distance << ',' << r.best_distance.distance << ',' << r.best_distance.routes << ',' << r.front.size() << ','
+                    << r.hypervolume << ',';
+            if (bks != known.end())
+                run_out << r.vehicle_gap << ',' << r.distance_gap_percent;
+            else
+                run_out << ',';
+            run_out << '\n';
+            for (const auto& f : r.front)
+                front_out << instance << ',' << r.seed << ',' << f.routes << ',' << f.distance << '\n';
+        }
+        for (const auto& m : METRICS)
+        {
+            std::vector<double> values;
+            for (const auto& r : results[i])
+                values.push_back(m.extract(r));
+            // instances without a best known solution have no gaps
+            if (std::any_of(values.begin(), values.end(), [](double v) { return std::isnan(v); }))
+                continue;
+            current[{instance, m.name}] = sample::of(values);
+        }
+    }
+
+    const auto baseline_path = args.get<std::string>("baseline");
+    if (args.get<int32_t>("update") != 0)
+    {
+        std::ofstream out(baseline_path);
+        out << "# generated by 2006_VRPTW_Pareto_regression --update 1 with " << runs << " runs from seed " << seed << " for " << generations
+            << " generations\n";
+        out << "Instance,Metric,Runs,Mean,StdDev\n";
+        out.precision(std::numeric_limits<double>::max_digits10);
+        for (const auto& [key, s] : current)
+            out << key.first << ',' << key.second << ',' << s.n << ',' << s.mean << ',' << s.stddev << '\n';
+        BLT_INFO("Baseline written to %s", baseline_path.c_str());
+        return 0;
+    }
+
+    const auto baseline = load_baseline(baseline_path);
+    blt::string::TableFormatter formatter{"Regression Against " + baseline_path};
+    formatter.addColumn({"Instance"});
+    formatter.addColumn({"Metric"});
+    formatter.addColumn({"Baseline"});
+    formatter.addColumn({"Current"});
+    formatter.addColumn({"Change"});
+    formatter.addColumn({"Verdict"});
+
+    size_t regressions = 0;
+    for (const auto& [key, s] : current)
+    {
+        const auto* m = &*std::find_if(METRICS.begin(), METRICS.end(), [&key](const metric& v) { return key.second == v.name; });
+        auto base = baseline.find(key);
+        if (base == baseline.end())
+        {
+            formatter.addRow({key.first, key.second, "-", std::to_string(s.mean), "-", "new"});
+            continue;
+        }
+        const auto& b = base->second;
+        auto change = s.mean - b.mean;
+        if (m->relative)
+            change = b.mean == 0 ? 0 : change / std::abs(b.mean);
+        auto worse = m->lower_is_better ? change > m->tolerance : change < -m->tolerance;
+        auto better = m->lower_is_better ? change < -m->tolerance : change > m->tolerance;
+        auto change_str = m->relative ? std::to_string(change * 100) + "%" : std::to_string(change);
+        std::string verdict = "ok";
+        if (m->informational)
+            verdict = "info";
+        else if (significant(s, b))
+        {
+            if (worse)
+            {
+                verdict = "REGRESSION";
+                regressions++;
+            } else if (better)
+                verdict = "improved";
+        }
+        formatter.addRow({key.first, key.second, std::to_string(b.mean), std::to_string(s.mean), change_str, verdict});
+    }
+
+    for (const auto& v : formatter.createTable(true, true))
+        std::cout << v << "\n";
+
+    if (regressions > 0)
+    {
+        BLT_ERROR("%d significant regressions against the baseline", regressions);
+        BLT_INFO("If the change is intended, re-baseline from a Release build with --update 1 and commit %s", baseline_path.c_str());
+        return 1;
+    }
+    BLT_INFO("No significant regressions against the baseline");
+    return 0;
+}
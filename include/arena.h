@@ -0,0 +1,104 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_ARENA_H
+#define INC_2006_VRPTW_PARETO_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <vector>
+
+namespace ga
+{
+
+    struct arena_stats
+    {
+        // handed out by the arena
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+        // blocks the arena had to take from the global heap to do so
+        std::uint64_t upstream_allocations = 0;
+        std::uint64_t upstream_bytes = 0;
+    };
+
+    /**
+     * Counts what passes through to another resource. Not synchronised, like the arena it sits in.
+     */
+    class counting_resource : public std::pmr::memory_resource
+    {
+        public:
+            explicit counting_resource(std::pmr::memory_resource* upstream): upstream(upstream)
+            {}
+
+            [[nodiscard]] inline std::uint64_t allocations() const
+            {
+                return allocation_count;
+            }
+
+            [[nodiscard]] inline std::uint64_t bytes() const
+            {
+                return byte_count;
+            }
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+
+            void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+            [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        private:
+            std::pmr::memory_resource* upstream;
+            std::uint64_t allocation_count = 0;
+            std::uint64_t byte_count = 0;
+    };
+
+    /**
+     * Scratch memory of one program: insertion trials, tournament buffers, route copies. Allocations are a pointer bump, freeing is a
+     * no-op, and everything is given back at once by release() at the end of each generation. The first block is kept across releases
+     * so a generation that fits in it never touches the global heap. Belongs to one thread at a time.
+     */
+    class scratch_arena
+    {
+        public:
+            static constexpr size_t INITIAL_BYTES = 64 * 1024;
+
+            scratch_arena();
+
+            scratch_arena(const scratch_arena&) = delete;
+
+            scratch_arena& operator=(const scratch_arena&) = delete;
+
+            inline std::pmr::memory_resource* resource()
+            {
+                return &front;
+            }
+
+            /**
+             * Frees everything handed out since the last release
+             * @return what was allocated since the last release
+             */
+            arena_stats release();
+
+        private:
+            std::unique_ptr<std::byte[]> initial;
+            counting_resource upstream;
+            std::pmr::monotonic_buffer_resource monotonic;
+            counting_resource front;
+            arena_stats released;
+    };
+
+    /**
+     * One row per generation plus a total row
+     */
+    void writeArenaCSV(std::ostream& out, const std::vector<arena_stats>& generations);
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_ARENA_H
@@ -0,0 +1,77 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_ASYNC_H
+#define INC_2006_VRPTW_PARETO_ASYNC_H
+
+#include <program.h>
+#include <mpmc_queue.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ga
+{
+
+    struct async_options
+    {
+        // threads running selection, crossover and mutation
+        size_t producers = 1;
+        // threads decoding and scoring offspring
+        size_t evaluators = 1;
+        // offspring waiting between two stages, rounded up to a power of two
+        size_t queue_capacity = 256;
+        // offspring integrated between two population snapshots handed to the producers, 0 is a quarter of the population
+        size_t snapshot_every = 0;
+    };
+
+    /**
+     * Runs a program steady state with no generation barrier. Producers breed offspring from the latest snapshot of the population,
+     * evaluators decode and score them, and the calling thread puts each one into the population and the pareto archive as it arrives.
+     * Clone immigrants are swapped in by the calling thread, which holds the live population.
+     * The stages only meet through lock-free queues, so the run is not reproducible from its seed.
+     */
+    class async_runner
+    {
+        public:
+            async_runner(program& master, async_options options);
+
+            /**
+             * Integrates generations * population size offspring, or fewer if the program's termination criteria are met first. The
+             * threads are started and joined by each call, offspring still in flight when it returns are dropped.
+             */
+            void run(std::uint64_t generations);
+
+        private:
+            template<typename Objective>
+            void run(std::uint64_t generations);
+
+            template<typename Objective>
+            void produce(program& worker);
+
+            void evaluate(program& worker);
+
+            // copies the master's population for the producers to breed from
+            void publish();
+
+            // the next snapshot if there is a newer one than seen
+            std::shared_ptr<const population> latest(std::uint64_t& seen);
+
+            program& master;
+            async_options options;
+            std::unique_ptr<mpmc_queue<individual>> bred, scored;
+            std::atomic_bool stopping = false;
+            std::mutex snapshot_mutex;
+            std::shared_ptr<const population> snapshot;
+            std::atomic_uint64_t snapshot_version = 0;
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_ASYNC_H
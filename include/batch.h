@@ -0,0 +1,192 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_BATCH_H
+#define INC_2006_VRPTW_PARETO_BATCH_H
+
+#include <program.h>
+#include <history.h>
+#include <profiling.h>
+#include <counters.h>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace ga
+{
+
+    /**
+     * How every run of a job is set up
+     */
+    struct batch_params
+    {
+        std::int32_t capacity = 200;
+        size_t runs = 50;
+        std::int32_t generations = DEFAULT_GENERATION_COUNT;
+        std::int32_t population = DEFAULT_POPULATION_SIZE;
+        std::int32_t tournament = DEFAULT_TOURNAMENT_SIZE;
+        std::int32_t elite = DEFAULT_ELITE_COUNT;
+        double crossover = DEFAULT_CROSSOVER_RATE;
+        double mutation = DEFAULT_MUTATION_RATE;
+        double mutation2 = DEFAULT_MUTATION_2_RATE;
+        objective_mode objective = objective_mode::PARETO;
+        // what the pareto ranking minimises
+        std::vector<objective_id> pareto_objectives = default_objectives();
+        // run a weighted sum twin next to every pareto run, it reports the wGA column. objective is ignored when paired
+        bool paired = true;
+        // generations is always set from the field above, the rest come from the stagnation, time_budget and evaluation_budget keys
+        termination_criteria termination;
+        step_mode stepping = step_mode::GENERATIONAL;
+        // replace the clones of every generation with random immigrants
+        bool immigrants = false;
+        // run j is seeded with seed + j, random seeds if not set
+        std::optional<std::uint64_t> seed;
+
+        // everything but the run count, two tasks with the same work key produce the same results
+        [[nodiscard]] std::string work_key() const;
+
+        // hash of the work key and SOLVER_VERSION, journaled with every result so a sweep never reuses one from other settings
+        [[nodiscard]] std::uint64_t journal_work() const;
+    };
+
+    struct batch_job
+    {
+        std::string name;
+        batch_params params;
+        std::vector<std::string> instances;
+    };
+
+    /**
+     * One instance of one job, the unit the scheduler orders
+     */
+    struct batch_task
+    {
+        std::string job;
+        std::string problem;
+        std::string instance;
+        batch_params params;
+        // row label in the tables, the instance and capacity unless two jobs run the same instance at the same capacity
+        std::string label;
+        // relative cost used to order the tasks, not a time
+        double expected_cost = 0;
+    };
+
+    /**
+     * Reads a batch manifest, see problems/default.manifest for the format. Returns no jobs if the manifest can not be read.
+     */
+    std::vector<batch_job> load_manifest(const std::string& path);
+
+    /**
+     * Expands jobs into one task per instance, merges tasks doing identical work (keeping the larger run count) and sorts them longest
+     * expected first so the long tasks do not end up alone at the end of the sweep
+     */
+    std::vector<batch_task> schedule_tasks(const std::vector<batch_job>& jobs);
+
+    struct batch_options
+    {
+        std::string manifest_path = "../problems/default.manifest";
+        history_config history;
+        // prefix of the per run binary history files, empty to not stream
+        std::string stream_path;
+        size_t checkpoint_every = 0;
+        std::string checkpoint_dir = "./checkpoints";
+        std::string journal_path = "./batch_journal.csv";
+        // stop running an instance once the 95% confidence interval of every objective's mean is within this fraction of the mean, 0 runs
+        // every instance to its full run count
+        double ci_target = 0;
+        // never settle an instance on fewer runs than this
+        size_t ci_min_runs = 10;
+        // finished seeded runs are kept here and reused by any later sweep doing the same work, empty to not cache
+        std::string cache_dir = "./cache";
+        // time to target is also measured against these, a run reaches an instance's target once it has a point with no more vehicles
+        // than the best known and a distance within target_gap of it
+        std::string known_path = "../problems/best_known.csv";
+        double target_gap = 0.05;
+        // one worker per allowed CPU, each pinned to it. Every NUMA node gets its own share of the runs and its own copy of the instances
+        // they use, a worker only takes runs from another node once its own are done.
+        bool pin_threads = false;
+    };
+
+    // fraction of a run's final archive hypervolume that counts as having reached it
+    static constexpr double HYPERVOLUME_TARGET = 0.99;
+
+    /**
+     * Everything the batch tables need from one finished run
+     */
+    struct run_result
+    {
+        std::string job;
+        std::string instance;
+        std::int32_t capacity = 0;
+        std::uint64_t run = 0;
+        // batch_params::journal_work of the task the run belongs to
+        std::uint64_t work = 0;
+        double seconds = 0;
+        individual_point best_cars;
+        individual_point best_distance;
+        individual_point best_fitness;
+        op_counters counters;
+        phase_profile profile;
+        // of the pareto run's final generation, NaN if it never ranked one
+        double hypervolume = std::numeric_limits<double>::quiet_NaN();
+        // generations the pareto run executed and why it stopped
+        std::uint64_t generations = 0;
+        stop_reason stopped = stop_reason::NONE;
+        // individuals evaluated by the run and its twin
+        std::uint64_t evaluations = 0;
+        // first point of the anytime trace within HYPERVOLUME_TARGET of the final archive hypervolume, NaN if the archive never improved
+        double hypervolume_target_seconds = std::numeric_limits<double>::quiet_NaN();
+        std::uint64_t hypervolume_target_evaluations = 0;
+        // first point meeting the best known target, NaN if never met or the instance has no best known solution
+        double known_target_seconds = std::numeric_limits<double>::quiet_NaN();
+        // every improvement of the pareto archive, cached but not journaled
+        std::vector<anytime_point> anytime;
+        // distinct rank 1 points of the final generation, not journaled
+        std::vector<individual_point> front;
+    };
+
+    /**
+     * Append only record of the finished runs of a batch sweep. Every result is written as one checksummed line and flushed as soon as
+     * it arrives, a restarted sweep reads the journal back and only runs what is missing. A line cut short by a crash fails its checksum
+     * and is dropped, so that run is simply done again, as is any line not in the one layout the journal has.
+     */
+    class batch_journal
+    {
+        public:
+            explicit batch_journal(const std::string& path);
+
+            [[nodiscard]] bool contains(const std::string& job, const std::string& instance, std::uint64_t work, std::uint64_t run);
+
+            // thread safe
+            void append(const run_result& result);
+
+            // every result in the order it was journaled, including the ones from earlier sessions
+            [[nodiscard]] std::vector<run_result> results();
+
+            [[nodiscard]] size_t size();
+
+        private:
+            static std::string key(const std::string& job, const std::string& instance, std::uint64_t work, std::uint64_t run);
+
+            std::mutex lock;
+            std::ofstream out;
+            std::vector<run_result> entries;
+            std::unordered_set<std::string> keys;
+    };
+
+    /**
+     * Runs the manifest's sweep across every hardware thread, prints the tables and writes results.txt and profile.csv
+     */
+    void run_batch(const batch_options& options);
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_BATCH_H
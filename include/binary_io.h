@@ -0,0 +1,116 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_BINARY_IO_H
+#define INC_2006_VRPTW_PARETO_BINARY_IO_H
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Raw native endian reads and writes of trivially copyable values, used by the binary history, checkpoint and cache formats.
+ */
+namespace ga::binary
+{
+
+    static constexpr std::uint64_t NO_LIMIT = std::numeric_limits<std::uint64_t>::max();
+
+    // bytes left to read, NO_LIMIT for a stream that can not seek
+    inline std::uint64_t remaining(std::istream& in)
+    {
+        const auto here = in.tellg();
+        if (here < 0)
+            return NO_LIMIT;
+        in.seekg(0, std::ios::end);
+        const auto end = in.tellg();
+        in.seekg(here);
+        return end > here ? static_cast<std::uint64_t>(end - here) : 0;
+    }
+
+    /**
+     * A length read from a file that is over its limit or longer than what is left of the file can only come from damage. It is refused
+     * before anything is allocated for it.
+     * @throws std::runtime_error if the length can not be right
+     */
+    template<typename T>
+    inline void check_length(std::istream& in, std::uint64_t size, std::uint64_t limit = NO_LIMIT)
+    {
+        if (size > limit || size > remaining(in) / sizeof(T))
+            throw std::runtime_error("Length " + std::to_string(size) + " is over its limit or runs past the end of the file");
+    }
+
+    template<typename T>
+    inline void write(std::ostream& out, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    inline bool read(std::istream& in, T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    // writes the elements only, the caller is responsible for knowing the size when reading back
+    template<typename T>
+    inline void write_array(std::ostream& out, const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    // the read functions taking a length throw std::runtime_error from check_length when it can not be right
+    template<typename T>
+    inline bool read_array(std::istream& in, std::vector<T>& values, size_t size, std::uint64_t limit = NO_LIMIT)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        check_length<T>(in, size, limit);
+        values.resize(size);
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(size * sizeof(T))));
+    }
+
+    // size prefixed
+    template<typename T>
+    inline void write_vector(std::ostream& out, const std::vector<T>& values)
+    {
+        write(out, static_cast<std::uint64_t>(values.size()));
+        write_array(out, values);
+    }
+
+    template<typename T>
+    inline bool read_vector(std::istream& in, std::vector<T>& values, std::uint64_t limit = NO_LIMIT)
+    {
+        std::uint64_t size = 0;
+        return read(in, size) && read_array(in, values, size, limit);
+    }
+
+    inline void write_string(std::ostream& out, const std::string& str)
+    {
+        write(out, static_cast<std::uint64_t>(str.size()));
+        out.write(str.data(), static_cast<std::streamsize>(str.size()));
+    }
+
+    inline bool read_string(std::istream& in, std::string& str, std::uint64_t limit = NO_LIMIT)
+    {
+        std::uint64_t size = 0;
+        if (!read(in, size))
+            return false;
+        check_length<char>(in, size, limit);
+        str.resize(size);
+        return static_cast<bool>(in.read(str.data(), static_cast<std::streamsize>(size)));
+    }
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_BINARY_IO_H
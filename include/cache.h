@@ -0,0 +1,60 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_CACHE_H
+#define INC_2006_VRPTW_PARETO_CACHE_H
+
+#include <batch.h>
+#include <loader.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ga
+{
+
+    /**
+     * Part of every cache key, bump it whenever a change alters what a seeded run produces so stale results are never reused
+     */
+    static constexpr auto SOLVER_VERSION = "vrptw-pareto-ga 2";
+
+    /**
+     * Hash of everything that decides the outcome of a seeded run: the loaded records, the capacity, the constructor parameters, the seed
+     * and the solver version
+     */
+    std::uint64_t run_key(const std::vector<record>& records, const batch_params& params, std::uint64_t seed);
+
+    /**
+     * Directory of finished runs, one file per key. Only seeded runs can be cached, a random seed is never repeated.
+     */
+    class result_cache
+    {
+        public:
+            // an empty directory disables the cache
+            explicit result_cache(std::string directory);
+
+            [[nodiscard]] bool enabled() const
+            {
+                return !dir.empty();
+            }
+
+            /**
+             * Fills in everything but the job, instance and run of result, returns false on a miss or an unreadable entry
+             */
+            bool lookup(std::uint64_t key, run_result& result) const;
+
+            // thread safe as long as two threads never store the same key, which the scheduler guarantees
+            void store(std::uint64_t key, const run_result& result) const;
+
+        private:
+            [[nodiscard]] std::string path(std::uint64_t key) const;
+
+            std::string dir;
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_CACHE_H
@@ -0,0 +1,79 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_COUNTERS_H
+#define INC_2006_VRPTW_PARETO_COUNTERS_H
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include <ostream>
+
+namespace ga
+{
+
+#ifdef GA_ENABLE_COUNTERS
+    static constexpr bool COUNTERS_ENABLED = true;
+#else
+    static constexpr bool COUNTERS_ENABLED = false;
+#endif
+
+    /**
+     * Machine independent measures of the work done by a run
+     */
+    enum class counter : std::uint8_t
+    {
+        DECODES, VALIDATIONS, REJECT_CAPACITY, REJECT_ARRIVAL, REJECT_RETURN, INSERTIONS_TRIED, MUTATION_RETRIES, DOMINANCE_CHECKS, COUNT
+    };
+
+    static constexpr std::array<const char*, static_cast<size_t>(counter::COUNT)> COUNTER_NAMES{
+            "decodes", "validations", "capacity_rejections", "arrival_rejections", "return_rejections", "insertions_tried",
+            "mutation_retries", "dominance_checks"
+    };
+
+    struct op_counters
+    {
+        std::array<std::uint64_t, static_cast<size_t>(counter::COUNT)> values{};
+
+        inline std::uint64_t& operator[](counter c)
+        {
+            return values[static_cast<size_t>(c)];
+        }
+
+        inline std::uint64_t operator[](counter c) const
+        {
+            return values[static_cast<size_t>(c)];
+        }
+
+        inline op_counters& operator+=(const op_counters& c)
+        {
+            for (size_t i = 0; i < values.size(); i++)
+                values[i] += c.values[i];
+            return *this;
+        }
+
+        inline void clear()
+        {
+            values = {};
+        }
+
+        /**
+         * Writes one row per counter, seconds is the time the counters were collected over and is used for the rate column
+         */
+        void writeCSV(std::ostream& out, std::uint64_t generations, double seconds) const;
+    };
+
+}
+
+#ifdef GA_ENABLE_COUNTERS
+    #define GA_COUNT(counters, name) (++(counters)[ga::counter::name])
+    #define GA_COUNT_N(counters, name, n) ((counters)[ga::counter::name] += (n))
+#else
+    #define GA_COUNT(counters, name)
+    #define GA_COUNT_N(counters, name, n)
+#endif
+
+#endif //INC_2006_VRPTW_PARETO_COUNTERS_H
@@ -0,0 +1,45 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_HASH_H
+#define INC_2006_VRPTW_PARETO_HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace ga
+{
+
+    static constexpr std::uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+    static constexpr std::uint64_t FNV_PRIME = 0x100000001b3ull;
+
+    /**
+     * 64 bit FNV-1a, chain calls by passing the previous hash as the seed
+     */
+    inline std::uint64_t fnv1a(const void* data, size_t size, std::uint64_t hash = FNV_OFFSET)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    constexpr std::uint64_t fnv1a(std::string_view str, std::uint64_t hash = FNV_OFFSET)
+    {
+        for (char c : str)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_HASH_H
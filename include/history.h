@@ -0,0 +1,137 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_HISTORY_H
+#define INC_2006_VRPTW_PARETO_HISTORY_H
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ga
+{
+
+    typedef std::int32_t rank_t;
+    typedef double fitness_t;
+
+    struct avg_point
+    {
+        double distance;
+        size_t routes;
+        size_t currentGen;
+    };
+
+    struct individual_point
+    {
+        double distance = 0;
+        fitness_t fitness = 0;
+        rank_t rank = 0;
+        size_t routes = 0;
+
+        static inline individual_point max()
+        {
+            return {std::numeric_limits<double>::max(), std::numeric_limits<fitness_t>::max(), std::numeric_limits<rank_t>::max(),
+                    std::numeric_limits<size_t>::max()};
+        }
+    };
+
+    enum class history_policy : std::uint8_t
+    {
+        // every individual of every generation
+        FULL,
+        // every individual of every k-th generation
+        EVERY_K,
+        // only the rank 1 individuals of every generation
+        RANK_ONE,
+        // every individual of the last M generations
+        RING
+    };
+
+    struct history_config
+    {
+        history_policy policy = history_policy::FULL;
+        // k for EVERY_K, M for RING
+        size_t interval = 1;
+
+        /**
+         * Parses "full", "every:<k>", "rank1" or "ring:<m>". Anything else is warned about and keeps the full history.
+         */
+        static history_config parse(const std::string& str);
+
+        [[nodiscard]] std::string to_string() const;
+    };
+
+    /**
+     * Per individual history of a run, stored as columns in blocks of at most one population per recorded generation.
+     */
+    class history_store
+    {
+        public:
+            history_store() = default;
+
+            history_store(history_config config, size_t population_size);
+
+            /**
+             * Starts recording a generation, returns false if the policy skips it. push() and end() must only be called when this returns true.
+             */
+            bool begin(size_t generation);
+
+            void push(const individual_point& p);
+
+            void end();
+
+            void clear();
+
+            // number of stored generations
+            [[nodiscard]] size_t size() const;
+
+            // generation number of the i-th oldest stored generation
+            [[nodiscard]] size_t generation(size_t i) const;
+
+            [[nodiscard]] size_t points(size_t i) const;
+
+            [[nodiscard]] individual_point point(size_t i, size_t j) const;
+
+            [[nodiscard]] size_t memory() const;
+
+            [[nodiscard]] const history_config& config() const
+            {
+                return conf;
+            }
+
+            void write_csv(std::ostream& out) const;
+
+            // binary snapshot of the whole store, including the ring position, used by checkpoints
+            void save(std::ostream& out) const;
+
+            bool load(std::istream& in);
+
+        private:
+            [[nodiscard]] size_t slot(size_t i) const;
+
+            history_config conf;
+            size_t stride = 0;
+            // how many generations have ever been stored, the ring slot of the next one is this modulo the ring size
+            size_t recorded = 0;
+            size_t open_slot = 0;
+
+            std::vector<double> distance;
+            std::vector<fitness_t> fitness;
+            std::vector<rank_t> rank;
+            std::vector<std::uint32_t> routes;
+
+            // per stored generation
+            std::vector<size_t> generations;
+            std::vector<size_t> offsets;
+            std::vector<size_t> counts;
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_HISTORY_H
@@ -0,0 +1,145 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_HISTORY_FILE_H
+#define INC_2006_VRPTW_PARETO_HISTORY_FILE_H
+
+#include <history.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Append only binary history file.
+ *
+ * layout (little endian, native widths):
+ *  header: "VRPH" | u32 version | u32 population size
+ *  block:  "BLK0" | u32 generations | u64 points | u64 generation[generations] | u32 count[generations]
+ *          | f64 distance[points] | f64 fitness[points] | i32 rank[points] | u32 vehicles[points]
+ * Blocks are only ever written whole and flushed, a block cut short by a crash is ignored by the reader.
+ */
+namespace ga
+{
+
+    static constexpr std::uint32_t HISTORY_FILE_VERSION = 1;
+
+    struct history_block
+    {
+        std::vector<std::uint64_t> generations;
+        std::vector<std::uint32_t> counts;
+        std::vector<double> distance;
+        std::vector<fitness_t> fitness;
+        std::vector<rank_t> rank;
+        std::vector<std::uint32_t> vehicles;
+
+        void clear();
+    };
+
+    /**
+     * Streams generations to disk, full blocks are handed to a background thread so the GA never waits on the disk.
+     */
+    class history_writer
+    {
+        public:
+            /**
+             * @param resume_at if non zero the file is cut back to this many bytes and appended to instead of being recreated,
+             * used to continue a stream from the offset recorded in a checkpoint
+             */
+            history_writer(const std::string& path, size_t population_size, size_t generations_per_block = 32, std::uint64_t resume_at = 0);
+
+            history_writer(const history_writer&) = delete;
+
+            history_writer& operator=(const history_writer&) = delete;
+
+            // flushes the partial block and joins the writer thread
+            ~history_writer();
+
+            void begin(size_t generation);
+
+            void push(const individual_point& p);
+
+            void end();
+
+            /**
+             * Writes out the partial block and waits for the writer thread to catch up.
+             * @return the size of the file in bytes, every generation pushed so far is on disk before this offset
+             */
+            std::uint64_t sync();
+
+            [[nodiscard]] const std::string& path() const
+            {
+                return file_path;
+            }
+
+            [[nodiscard]] size_t generations_per_block() const
+            {
+                return block_size;
+            }
+
+        private:
+            void run();
+
+            std::string file_path;
+            std::ofstream out;
+            // bytes on disk, tracked by hand since tellp() is unreliable on a file opened for appending
+            std::uint64_t written = 0;
+            size_t block_size;
+            history_block current;
+
+            std::mutex queue_lock;
+            std::condition_variable queue_cv;
+            std::condition_variable drained_cv;
+            std::deque<history_block> queue;
+            bool writing = false;
+            bool stopping = false;
+            std::thread worker;
+    };
+
+    class history_reader
+    {
+        public:
+            explicit history_reader(const std::string& path);
+
+            [[nodiscard]] bool valid() const
+            {
+                return header_ok;
+            }
+
+            [[nodiscard]] std::uint32_t population_size() const
+            {
+                return population;
+            }
+
+            /**
+             * Reads the next complete block, returns false at the end of the file or at a truncated block
+             */
+            bool next(history_block& block);
+
+            /**
+             * Calls f(generation, points) for every stored generation
+             */
+            void for_each(const std::function<void(std::uint64_t, const std::vector<individual_point>&)>& f);
+
+        private:
+            std::ifstream in;
+            std::uint32_t population = 0;
+            bool header_ok = false;
+    };
+
+    /**
+     * Converts a binary history file to the CSV written by history_store::write_csv, returns the number of generations converted
+     */
+    size_t convert_history(const std::string& binary_path, const std::string& csv_path);
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_HISTORY_FILE_H
@@ -0,0 +1,104 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_ISLANDS_H
+#define INC_2006_VRPTW_PARETO_ISLANDS_H
+
+#include <program.h>
+#include <mpmc_queue.h>
+#include <objectives.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ga
+{
+
+    enum class migration_topology : std::uint8_t
+    {
+        // island i sends to island i + 1, the last to the first
+        RING = 0,
+        // every migration goes to another island picked at random
+        RANDOM = 1
+    };
+
+    std::string_view to_string(migration_topology topology);
+
+    bool parse_topology(std::string_view str, migration_topology& topology);
+
+    // the seed of island i of a run seeded with seed, island 0 keeps it
+    std::uint64_t island_seed(std::uint64_t seed, size_t island);
+
+    // where island sends its migrants, the random topology draws from the island's own engine
+    size_t migration_target(migration_topology topology, size_t island, size_t islands, random_engine& engine);
+
+    struct island_options
+    {
+        // sub-populations, each on its own thread, including the home program
+        size_t islands = 4;
+        // generations between two migrations, 0 never migrates
+        size_t interval = 10;
+        // front members each island sends per migration
+        size_t migrants = 2;
+        migration_topology topology = migration_topology::RING;
+    };
+
+    /**
+     * Solves one instance with several programs at once. The home program is island 0, the others copy its parameters, objectives and
+     * termination criteria and start from their own random populations with their own random streams. Every interval generations an
+     * island posts copies of some of its front to another island's mailbox and takes in whatever is waiting in its own. Mailboxes are
+     * lock-free queues, an island never waits on another and migrants that do not fit are dropped, so runs are not reproducible from the
+     * seed.
+     */
+    class island_model
+    {
+        public:
+            island_model(program& home, island_options options);
+
+            /**
+             * Steps every island up to generations more times, an island stops early once its own termination criteria are met. The
+             * threads are started and joined by each call.
+             */
+            void run(std::uint64_t generations);
+
+            // every island's archive merged
+            [[nodiscard]] inline const pareto_archive& getArchive() const
+            {
+                return archive;
+            }
+
+            [[nodiscard]] double getHypervolume() const;
+
+            // one row per island and the merged front
+            [[nodiscard]] std::vector<std::string> createTable() const;
+
+        private:
+            void run_island(size_t i, std::uint64_t generations);
+
+            void migrate(size_t i);
+
+            struct island_stats
+            {
+                std::uint64_t sent = 0;
+                std::uint64_t received = 0;
+                std::uint64_t dropped = 0;
+            };
+
+            program& home;
+            island_options options;
+            // islands[0] is not owned, it is the home program
+            std::vector<std::unique_ptr<program>> owned;
+            std::vector<program*> islands;
+            std::vector<std::unique_ptr<mpmc_queue<individual>>> mailboxes;
+            std::vector<island_stats> stats;
+            pareto_archive archive;
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_ISLANDS_H
@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 struct record
 {
@@ -21,4 +22,16 @@ struct record
 
 std::vector<record> load_problem(const std::string& path);
 
+struct best_known
+{
+    std::int32_t vehicles;
+    double distance;
+};
+
+// best known solutions keyed by instance name (file name without extension), read from a "Instance,Vehicles,Distance" CSV
+std::unordered_map<std::string, best_known> load_best_known(const std::string& path);
+
+// vehicle capacity of the Solomon class the instance file belongs to (c1/r1/rc1: 200, c2: 700, r2/rc2: 1000)
+std::int32_t solomon_capacity(const std::string& path);
+
 #endif //INC_2006_VRPTW_PARETO_LOADER_H
@@ -0,0 +1,114 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_MPMC_QUEUE_H
+#define INC_2006_VRPTW_PARETO_MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace ga
+{
+
+    /**
+     * Bounded lock-free multi producer multi consumer queue (Vyukov). Every cell carries a sequence number that says whose turn it is, a
+     * producer or consumer claims a position with one compare exchange and never waits on another thread holding a lock.
+     */
+    template<typename T>
+    class mpmc_queue
+    {
+        private:
+            struct cell
+            {
+                std::atomic<size_t> sequence;
+                T value;
+            };
+
+            static constexpr size_t CACHE_LINE = 64;
+
+            std::unique_ptr<cell[]> cells;
+            const size_t mask;
+            alignas(CACHE_LINE) std::atomic<size_t> tail{0};
+            alignas(CACHE_LINE) std::atomic<size_t> head{0};
+
+            static size_t round_up(size_t capacity)
+            {
+                size_t size = 2;
+                while (size < capacity)
+                    size <<= 1;
+                return size;
+            }
+
+        public:
+            // the capacity is rounded up to a power of two
+            explicit mpmc_queue(size_t capacity): cells(new cell[round_up(capacity)]), mask(round_up(capacity) - 1)
+            {
+                for (size_t i = 0; i <= mask; i++)
+                    cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            mpmc_queue(const mpmc_queue&) = delete;
+
+            mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+            /**
+             * @return false if the queue is full, value is only moved from on success
+             */
+            bool try_push(T& value)
+            {
+                auto pos = tail.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    auto& c = cells[pos & mask];
+                    const auto sequence = c.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                    if (diff == 0)
+                    {
+                        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            c.value = std::move(value);
+                            c.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0)
+                        return false;
+                    else
+                        pos = tail.load(std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * @return false if the queue is empty
+             */
+            bool try_pop(T& value)
+            {
+                auto pos = head.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    auto& c = cells[pos & mask];
+                    const auto sequence = c.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+                    if (diff == 0)
+                    {
+                        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            value = std::move(c.value);
+                            c.sequence.store(pos + mask + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0)
+                        return false;
+                    else
+                        pos = head.load(std::memory_order_relaxed);
+                }
+            }
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_MPMC_QUEUE_H
@@ -0,0 +1,45 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_NUMA_H
+#define INC_2006_VRPTW_PARETO_NUMA_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace ga
+{
+
+    struct numa_node
+    {
+        std::int32_t id = 0;
+        std::vector<std::int32_t> cpus;
+    };
+
+    /**
+     * Parses a kernel CPU list such as "0-3,8,10-11". Fails on anything else, the list may be empty.
+     */
+    bool parse_cpu_list(std::string_view str, std::vector<std::int32_t>& cpus);
+
+    /**
+     * NUMA nodes from /sys/devices/system/node with only the CPUs this process is allowed to run on, nodes left with none (memory only
+     * nodes) are dropped. A machine without that tree is one node holding every allowed CPU.
+     */
+    std::vector<numa_node> numa_topology();
+
+    /**
+     * Pins the calling thread to one CPU. Memory it touches first is then placed on that CPU's node by the kernel's default policy.
+     * @return false if the kernel refused
+     */
+    bool pin_current_thread(std::int32_t cpu);
+
+    // the CPU the calling thread is running on, -1 if unknown
+    std::int32_t current_cpu();
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_NUMA_H
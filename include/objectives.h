@@ -0,0 +1,224 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_OBJECTIVES_H
+#define INC_2006_VRPTW_PARETO_OBJECTIVES_H
+
+#include <history.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ga
+{
+
+    /**
+     * Quantities a pareto run can minimise, every one is computed from the decoded routes
+     */
+    enum class objective_id : std::uint8_t
+    {
+        // number of routes
+        VEHICLES = 0,
+        // total travel distance
+        DISTANCE = 1,
+        // total time spent waiting for a customer's window to open
+        WAITING = 2,
+        // longest route duration minus the shortest
+        IMBALANCE = 3
+    };
+
+    static constexpr size_t MAX_OBJECTIVES = 4;
+
+    std::string_view to_string(objective_id id);
+
+    // the (vehicles, distance) pair the solver has always ranked on
+    std::vector<objective_id> default_objectives();
+
+    /**
+     * Parses a comma separated list such as "vehicles,distance,waiting". Fails on unknown names, repeats, or fewer than two objectives.
+     */
+    bool parse_objectives(std::string_view str, std::vector<objective_id>& ids);
+
+    // the inverse of parse_objectives
+    std::string to_string(const std::vector<objective_id>& ids);
+
+    /**
+     * Area dominated by the points and bounded by the reference point, both coordinates minimised. Points outside the reference box add
+     * nothing. Sorts the points in place, O(n log n).
+     */
+    double hypervolume_2d(std::vector<std::pair<double, double>>& points, double reference_x, double reference_y);
+
+    /**
+     * Every (vehicles, distance) point of a run that no other point seen so far dominates, sorted by vehicles with strictly falling
+     * distance
+     */
+    class pareto_archive
+    {
+        public:
+            /**
+             * Adds the point unless an archived point dominates or equals it, archived points it dominates are dropped
+             * @return true if the archive changed
+             */
+            bool insert(double vehicles, double distance);
+
+            [[nodiscard]] inline const std::vector<std::pair<double, double>>& points() const
+            {
+                return front;
+            }
+
+            [[nodiscard]] double hypervolume(double reference_x, double reference_y) const;
+
+            inline void clear()
+            {
+                front.clear();
+            }
+
+        private:
+            std::vector<std::pair<double, double>> front;
+    };
+
+    /**
+     * Objective vectors of a population stored one column per objective, so comparing one individual against all the others walks k
+     * contiguous arrays
+     */
+    class objective_matrix
+    {
+        public:
+            void reset(size_t objectives, size_t individuals);
+
+            [[nodiscard]] inline size_t objectives() const
+            {
+                return k;
+            }
+
+            [[nodiscard]] inline size_t size() const
+            {
+                return n;
+            }
+
+            inline double* column(size_t objective)
+            {
+                return values.data() + objective * n;
+            }
+
+            [[nodiscard]] inline const double* column(size_t objective) const
+            {
+                return values.data() + objective * n;
+            }
+
+            /**
+             * u dominates v iff ∀i ∈ (1, ..., k) : ui ≤ vi ∧ ∃i ∈ (1, ..., k) : ui < vi
+             */
+            [[nodiscard]] bool dominates(size_t u, size_t v) const;
+
+            /**
+             * Sets out[v] to 1 where u dominates v and 0 elsewhere, for every v at once, strict is scratch space of the same size. The loops
+             * have no branches so the compiler vectorises them whatever k is.
+             */
+            void dominated_by(size_t u, std::uint8_t* out, std::uint8_t* strict) const;
+
+        private:
+            size_t k = 0;
+            size_t n = 0;
+            std::vector<double> values;
+    };
+
+    /**
+     * Fast non-dominated sort (Deb et al. 2002): rank 1 is the non-dominated set, rank r is non-dominated once ranks below r are removed.
+     * Every pair is compared once in each direction whatever the number of fronts, the buffers are kept between calls.
+     */
+    class non_dominated_sorter
+    {
+        public:
+            /**
+             * Ranks every individual of the matrix
+             * @return the number of dominance checks made
+             */
+            std::uint64_t sort(const objective_matrix& m, std::vector<rank_t>& ranks);
+
+        private:
+            // row u holds which individuals u dominates
+            std::vector<std::uint8_t> dominance;
+            std::vector<std::uint8_t> strict;
+            // how many not yet ranked individuals dominate each one
+            std::vector<std::uint32_t> dominated_count;
+            std::vector<std::uint32_t> front, next_front;
+    };
+
+    /**
+     * Non-domination levels kept up to date one insertion or removal at a time (Li et al., efficient non-domination level update). Each
+     * front is kept in lexicographic order of the objective vectors, only points before p in that order can dominate it and only points
+     * after it can be dominated by it. The front a point lands in is found by binary search over the fronts (ENS-BS), since a point
+     * dominated by a member of front i is dominated by a member of every front before it.
+     */
+    class incremental_fronts
+    {
+        public:
+            /**
+             * Drops every point and takes the ranks of a full sort of the matrix as the starting fronts
+             */
+            void assign(const objective_matrix& m, const std::vector<rank_t>& ranks);
+
+            /**
+             * Adds a point with the next id, size() before the call. Points it dominates move down a front, and so on down the fronts.
+             * @param values k objective values
+             * @param ranks rank of every id, grown by one and updated for every point that moved
+             * @return the number of dominance checks made
+             */
+            std::uint64_t insert(const double* values, std::vector<rank_t>& ranks);
+
+            /**
+             * Removes a point of the last front, nothing else changes level. The point with the highest id takes the removed id so ids stay
+             * dense, the caller moves its own data the same way.
+             */
+            void remove(std::uint32_t id, std::vector<rank_t>& ranks);
+
+            [[nodiscard]] inline const std::vector<std::uint32_t>& last_front() const
+            {
+                return fronts.back();
+            }
+
+            [[nodiscard]] inline size_t front_count() const
+            {
+                return fronts.size();
+            }
+
+            [[nodiscard]] inline size_t size() const
+            {
+                return k == 0 ? 0 : values.size() / k;
+            }
+
+            [[nodiscard]] inline bool empty() const
+            {
+                return values.empty();
+            }
+
+        private:
+            [[nodiscard]] inline const double* point(std::uint32_t id) const
+            {
+                return values.data() + static_cast<size_t>(id) * k;
+            }
+
+            [[nodiscard]] bool dominates(std::uint32_t u, std::uint32_t v) const;
+
+            [[nodiscard]] bool lexicographically_less(std::uint32_t u, std::uint32_t v) const;
+
+            // where id goes in the front to keep it sorted
+            [[nodiscard]] std::vector<std::uint32_t>::iterator position(std::vector<std::uint32_t>& front, std::uint32_t id) const;
+
+            size_t k = 0;
+            // row major, one row of k values per id
+            std::vector<double> values;
+            std::vector<std::vector<std::uint32_t>> fronts;
+            std::vector<std::uint32_t> moving, moved;
+            std::uint64_t checks = 0;
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_OBJECTIVES_H
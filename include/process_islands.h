@@ -0,0 +1,79 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_PROCESS_ISLANDS_H
+#define INC_2006_VRPTW_PARETO_PROCESS_ISLANDS_H
+
+#include <program.h>
+#include <islands.h>
+#include <objectives.h>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace ga
+{
+
+    /**
+     * The island model with one forked process per island instead of a thread. Each worker builds its island from the launcher's program
+     * and runs it, migrants travel serialised through per island rings in a POSIX shared memory region and every worker publishes its
+     * archive there after each generation. A worker that crashes only loses its island, the launcher still merges the last archive it
+     * published. The launcher's own program is only the template and never steps.
+     */
+    class process_islands
+    {
+        public:
+            process_islands(program& home, island_options options);
+
+            /**
+             * Forks the workers and waits for every one of them, each steps its island up to generations times or until its termination
+             * criteria are met
+             * @return false if the shared memory or a fork failed, or no worker finished its run
+             */
+            bool run(std::uint64_t generations);
+
+            [[nodiscard]] inline const pareto_archive& getArchive() const
+            {
+                return archive;
+            }
+
+            [[nodiscard]] double getHypervolume() const;
+
+            // one row per worker and the merged front
+            [[nodiscard]] std::vector<std::string> createTable() const;
+
+            // the merged front as vehicles,distance rows
+            bool writeFront(const std::string& path) const;
+
+        private:
+            struct shared_region;
+
+            [[noreturn]] void run_worker(shared_region& region, size_t i, std::uint64_t generations);
+
+            struct worker_result
+            {
+                pid_t pid = -1;
+                // what waitpid reported, finished is a clean exit after the last generation
+                bool finished = false;
+                int signal = 0;
+                int exit_code = 0;
+                std::uint64_t generations = 0;
+                std::uint64_t sent = 0;
+                std::uint64_t received = 0;
+                std::uint64_t dropped = 0;
+                std::vector<std::pair<double, double>> front;
+            };
+
+            program& home;
+            island_options options;
+            std::vector<worker_result> workers;
+            pareto_archive archive;
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_PROCESS_ISLANDS_H
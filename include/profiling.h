@@ -0,0 +1,129 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_PROFILING_H
+#define INC_2006_VRPTW_PARETO_PROFILING_H
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <trace.h>
+
+namespace ga
+{
+
+    /**
+     * The phases of a single program::executeStep(), in the order they run.
+     */
+    enum class phase : std::uint8_t
+    {
+        RECONSTRUCT, FITNESS, RANK, HISTORY, ELITISM, CROSSOVER, MUTATION, REBUILD, COUNT
+    };
+
+    static constexpr std::array<const char*, static_cast<size_t>(phase::COUNT)> PHASE_NAMES{
+            "reconstruct", "fitness", "rank", "history", "elitism", "crossover", "mutation", "rebuild"
+    };
+
+    struct phase_timing
+    {
+        std::uint64_t samples = 0;
+        std::uint64_t total_ns = 0;
+        std::uint64_t min_ns = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t max_ns = 0;
+
+        inline void add(std::uint64_t ns)
+        {
+            samples++;
+            total_ns += ns;
+            min_ns = std::min(min_ns, ns);
+            max_ns = std::max(max_ns, ns);
+        }
+
+        inline void merge(const phase_timing& t)
+        {
+            samples += t.samples;
+            total_ns += t.total_ns;
+            min_ns = std::min(min_ns, t.min_ns);
+            max_ns = std::max(max_ns, t.max_ns);
+        }
+
+        [[nodiscard]] inline double average() const
+        {
+            return samples == 0 ? 0 : static_cast<double>(total_ns) / static_cast<double>(samples);
+        }
+    };
+
+    /**
+     * Per generation timings of each phase. A program keeps one for its run, the batch mode merges them per thread and overall.
+     */
+    struct phase_profile
+    {
+        std::array<phase_timing, static_cast<size_t>(phase::COUNT)> phases{};
+
+        inline phase_timing& operator[](phase p)
+        {
+            return phases[static_cast<size_t>(p)];
+        }
+
+        inline const phase_timing& operator[](phase p) const
+        {
+            return phases[static_cast<size_t>(p)];
+        }
+
+        inline void merge(const phase_profile& p)
+        {
+            for (size_t i = 0; i < phases.size(); i++)
+                phases[i].merge(p.phases[i]);
+        }
+
+        inline void clear()
+        {
+            phases = {};
+        }
+
+        [[nodiscard]] std::uint64_t total() const;
+
+        [[nodiscard]] std::vector<std::string> createTable(const std::string& name) const;
+
+        static void writeCSVHeader(std::ostream& out);
+
+        void writeCSV(std::ostream& out, const std::string& label) const;
+    };
+
+    /**
+     * Times the enclosing scope into one phase of a profile, and onto the trace timeline when one is being recorded
+     */
+    class phase_timer
+    {
+        private:
+            phase_timing& timing;
+            phase p;
+            std::chrono::steady_clock::time_point start;
+        public:
+            phase_timer(phase_profile& profile, phase p): timing(profile[p]), p(p), start(std::chrono::steady_clock::now())
+            {}
+
+            phase_timer(const phase_timer&) = delete;
+
+            phase_timer& operator=(const phase_timer&) = delete;
+
+            ~phase_timer()
+            {
+                auto end = std::chrono::steady_clock::now();
+                timing.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+                if (trace::enabled())
+                    trace::record(PHASE_NAMES[static_cast<size_t>(p)], "phase", start, end);
+            }
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_PROFILING_H
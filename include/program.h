@@ -10,9 +10,24 @@
 
 #include <cstdint>
 #include <loader.h>
+#include <profiling.h>
+#include <counters.h>
+#include <history.h>
+#include <history_file.h>
+#include <objectives.h>
+#include <termination.h>
+#include <arena.h>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <array>
+#include <chrono>
 #include <cstring>
 #include <algorithm>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
 #include <blt/std/logging.h>
 #include <blt/std/random.h>
 #include <blt/std/string.h>
@@ -22,8 +37,6 @@ namespace ga
 {
     
     typedef std::int32_t customerID_t;
-    typedef std::int32_t rank_t;
-    typedef double fitness_t;
     typedef double distance_t;
     
     static constexpr std::int32_t CUSTOMER_COUNT = 100;
@@ -58,6 +71,8 @@ namespace ga
         distance_t total_routes_distance = 0;
         rank_t rank = 0;
         fitness_t fitness = 0;
+        // FNV-1a of the genes, kept up to date by reconstruct_chromosome. 0 means not known yet, it is worked out before decoding
+        std::uint64_t hash = 0;
     };
     
     struct population
@@ -65,62 +80,153 @@ namespace ga
         std::vector<individual> pops;
     };
     
-    struct avg_point
+    // the checkpoint encoding of an individual, migrants between processes are sent in it too
+    void write_individual(std::ostream& out, const individual& i);
+    
+    bool read_individual(std::istream& in, individual& i);
+    
+    /**
+     * How a program compares individuals. The generation loop is instantiated once per mode on the matching policy below, a program picks
+     * its instantiation once per generation instead of branching inside selection and ranking.
+     */
+    enum class objective_mode : std::uint8_t
     {
-        double distance;
-        size_t routes;
-        size_t currentGen;
+        // non-dominated sorting on (vehicles, distance)
+        PARETO = 0,
+        // ALPHA * vehicles + BETA * distance
+        WEIGHTED_SUM = 1,
+        // fewest vehicles, distance breaks ties
+        LEXICOGRAPHIC = 2
     };
     
-    struct individual_point
+    std::string_view to_string(objective_mode mode);
+    
+    // accepts pareto, weighted_sum and lexicographic, returns false on anything else
+    bool parse_objective(std::string_view str, objective_mode& mode);
+    
+    /**
+     * How executeStep replaces the population. Either way one step breeds a population's worth of offspring and counts as a generation.
+     */
+    enum class step_mode : std::uint8_t
     {
-        double distance = 0;
-        fitness_t fitness = 0;
-        rank_t rank = 0;
-        size_t routes = 0;
+        // every offspring is bred from the last population, which is then replaced whole
+        GENERATIONAL = 0,
+        // offspring are bred one crossover at a time, each goes straight into the population in place of its worst member
+        STEADY_STATE = 1
+    };
+    
+    std::string_view to_string(step_mode mode);
+    
+    // accepts generational and steady_state, returns false on anything else
+    bool parse_step_mode(std::string_view str, step_mode& mode);
+    
+    /**
+     * Pareto ranks are the only order, the population is sorted by rank and selection compares ranks.
+     */
+    struct pareto_objective
+    {
+        static constexpr objective_mode mode = objective_mode::PARETO;
+        static constexpr bool total_order = false;
+        
+        static inline bool better(const individual& a, const individual& b)
+        {
+            return a.rank < b.rank;
+        }
+    };
+    
+    /**
+     * Total orders only need their best few individuals in front, ranking is a partial sort and rank 1 marks the individuals tied with the
+     * best, everyone else is rank 2.
+     */
+    struct weighted_sum_objective
+    {
+        static constexpr objective_mode mode = objective_mode::WEIGHTED_SUM;
+        static constexpr bool total_order = true;
         
-        static inline individual_point max()
+        static inline bool better(const individual& a, const individual& b)
         {
-            return {std::numeric_limits<double>::max(), std::numeric_limits<fitness_t>::max(), std::numeric_limits<rank_t>::max(),
-                    std::numeric_limits<size_t>::max()};
+            return a.fitness < b.fitness;
         }
         
-        individual_point& operator+=(individual_point p)
+        static inline bool tied(const individual& a, const individual& b)
         {
-            distance += p.distance;
-            routes += p.routes;
-            return *this;
+            return a.fitness >= b.fitness - EPSILON && a.fitness <= b.fitness + EPSILON;
         }
+    };
+    
+    struct lexicographic_objective
+    {
+        static constexpr objective_mode mode = objective_mode::LEXICOGRAPHIC;
+        static constexpr bool total_order = true;
         
-        individual_point& operator/=(int32_t d)
+        static inline bool better(const individual& a, const individual& b)
         {
-            distance /= static_cast<double>(d);
-            routes /= static_cast<size_t>(d);
-            return *this;
+            return a.routes.size() < b.routes.size() ||
+                   (a.routes.size() == b.routes.size() && a.total_routes_distance < b.total_routes_distance);
+        }
+        
+        static inline bool tied(const individual& a, const individual& b)
+        {
+            return a.routes.size() == b.routes.size() && a.total_routes_distance >= b.total_routes_distance - EPSILON &&
+                   a.total_routes_distance <= b.total_routes_distance + EPSILON;
         }
     };
     
-    struct generation_point
+    /**
+     * A loaded instance and the tables derived from it. It never changes once built, so any number of programs can share one.
+     */
+    struct problem_instance
     {
-        size_t currentGen;
-        std::vector<individual_point> indv;
+        std::int32_t capacity;
+        std::vector<record> records;
+        // distance between every pair of records, row major
+        std::vector<distance_t> distances;
+        // hypervolume reference point, just worse than one route per customer, which bounds every feasible solution
+        double reference_vehicles = 0;
+        double reference_distance = 0;
+        
+        problem_instance(std::int32_t capacity, std::vector<record>&& records);
+        
+        [[nodiscard]] inline distance_t distance(customerID_t c1, customerID_t c2) const
+        {
+            return distances[static_cast<size_t>(c1) * records.size() + static_cast<size_t>(c2)];
+        }
     };
-
-#define RANDOM_STATIC static thread_local
-//#define RANDOM_ENGINE() RANDOM_STATIC std::random_device dev; \
-//    std::seed_seq seq{dev(), dev()}; \
-//    RANDOM_STATIC std::mt19937_64 engine(seq);
     
     class random_engine
     {
         private:
-        
+            std::mt19937_64 engine;
         public:
+            random_engine(): engine(random_seed())
+            {}
+            
+            explicit random_engine(std::uint64_t seed): engine(seed)
+            {}
+            
+            static inline std::uint64_t random_seed()
+            {
+                std::random_device dev;
+                return (static_cast<std::uint64_t>(dev()) << 32) | dev();
+            }
+            
+            // full generator state in the standard text form, restoring it continues the exact same sequence
+            [[nodiscard]] inline std::string state() const
+            {
+                std::ostringstream str;
+                str << engine;
+                return str.str();
+            }
+            
+            inline bool restore(const std::string& state)
+            {
+                std::istringstream str(state);
+                str >> engine;
+                return !str.fail();
+            }
+            
             inline double getDouble(double min, double max)
             {
-                RANDOM_STATIC std::random_device dev;
-                RANDOM_STATIC std::seed_seq seq{dev(), dev()};
-                RANDOM_STATIC std::mt19937_64 engine(seq);
                 std::uniform_real_distribution dist(min, max);
                 return dist(engine);
             }
@@ -132,27 +238,18 @@ namespace ga
             
             inline std::int32_t getInt(std::int32_t min, std::int32_t max)
             {
-                RANDOM_STATIC std::random_device dev;
-                RANDOM_STATIC std::seed_seq seq{dev(), dev()};
-                RANDOM_STATIC std::mt19937_64 engine(seq);
                 std::uniform_int_distribution dist(min, max);
                 return dist(engine);
             }
             
             inline std::int64_t getLong(std::int64_t min, std::int64_t max)
             {
-                RANDOM_STATIC std::random_device dev;
-                RANDOM_STATIC std::seed_seq seq{dev(), dev()};
-                RANDOM_STATIC std::mt19937_64 engine(seq);
                 std::uniform_int_distribution dist(min, max);
                 return dist(engine);
             }
             
             inline std::uint64_t getLong(std::uint64_t min, std::uint64_t max)
             {
-                RANDOM_STATIC std::random_device dev;
-                RANDOM_STATIC std::seed_seq seq{dev(), dev()};
-                RANDOM_STATIC std::mt19937_64 engine(seq);
                 std::uniform_int_distribution dist(min, max);
                 return dist(engine);
             }
@@ -160,13 +257,30 @@ namespace ga
     
     class program
     {
+        // lets the benchmark suite time the private kernels directly
+        friend struct kernel_access;
+        friend class async_runner;
+        friend class island_model;
+        friend class process_islands;
         private:
+            // everything read from a checkpoint file, see checkpoint.cpp
+            struct checkpoint_state;
+            
+            static checkpoint_state read_checkpoint(const std::string& path);
+            
+            explicit program(checkpoint_state&& state);
+            
             double distance(customerID_t c1, customerID_t c2);
             
             double calculate_distance(const route& r);
             
+            // the same for a route's customers held anywhere, the insertion trials keep theirs in the scratch arena
+            double calculate_distance(std::span<const customerID_t> customers);
+            
             bool validate_route(const route& r);
             
+            bool validate_route(std::span<const customerID_t> customers);
+            
             void constraintFailurePrint(const route& r);
             
             void validate_route(const std::string& str, std::vector<int32_t>& values)
@@ -198,18 +312,24 @@ namespace ga
                 BLT_TRACE("%f %f", cap, lastLeaveTime);
             }
             
-            static bool dominates(const individual& u, const individual& v);
+            // time the route ends, adds the time spent waiting for windows to open to waiting
+            double route_duration(const route& r, double& waiting);
             
-            bool is_non_dominated(customerID_t v);
+            double objective_value(const individual& i, objective_id id);
             
             static double weighted_sum_fitness(individual& v);
             
+            template<typename Objective>
             customerID_t select_pop(size_t tournament_size);
             
             static void remove_from(const route& r, individual& c);
             
             void insert_to(const route& r_in, individual& c_in);
             
+            /**
+             * Decodes every chromosome into routes. A chromosome already decoded this generation or last generation has its routes copied
+             * instead, clones found this generation are replaced with random immigrants if enabled.
+             */
             void reconstruct_populations();
             
             static void reconstruct_chromosome(individual& i);
@@ -217,6 +337,101 @@ namespace ga
             static void rebuild_population_chromosomes(population& pop);
             
             void add_step_to_history();
+            
+            template<typename Objective>
+            void step();
+            
+            template<typename Objective>
+            void steady_state_step();
+            
+            // ranks the decoded population from scratch and builds the incremental fronts (or the sorted order) the steady state keeps
+            template<typename Objective>
+            void rank_steady_state();
+            
+            /**
+             * Puts a decoded and evaluated offspring into the population and drops the worst member, which may be the offspring. Pareto
+             * drops the member of the last front with the highest weighted sum fitness, total orders drop the last in their order.
+             */
+            template<typename Objective>
+            void insert_offspring(individual&& offspring);
+            
+            // the pieces of a steady state step, an async_runner runs them on different threads
+            template<typename Objective>
+            void prepare_steady_state();
+            
+            // one crossover's offspring, mutated and with their chromosomes rebuilt
+            template<typename Objective>
+            void breed_offspring(population& out);
+            
+            // decodes the routes and works out the fitness
+            void evaluate_offspring(individual& child);
+            
+            // the member of the current population with the offspring's genes, nullptr if there is none
+            [[nodiscard]] const individual* find_clone(individual& child) const;
+            
+            /**
+             * The steady state counterpart of the clone check in reconstruct_populations, run on each offspring against the population it
+             * goes into. With clone immigrants on, a clone of a member is replaced by a random chromosome.
+             * @return true if the offspring was replaced and needs decoding again
+             */
+            bool replace_clone(individual& child);
+            
+            // evaluate_offspring, except a clone of a member takes its routes instead of being decoded
+            void evaluate_unique_offspring(individual& child);
+            
+            // adds the offspring to the pareto archive as soon as it arrives rather than with the rest of its generation
+            bool archive_offspring(const individual& child);
+            
+            // elapsed() plus the time spent in the step under way
+            [[nodiscard]] double stepping_seconds() const;
+            
+            template<typename Objective>
+            void finish_steady_state_generation();
+            
+            /**
+             * A program that only breeds or evaluates for the master's async_runner: same instance, parameters and objectives, its own
+             * random stream, counters and profile. Its population is a snapshot of the master's.
+             */
+            program(const program& master, std::uint64_t seed);
+            
+            /**
+             * A copy with the current population decoded, without immigrants, and ranked. The read only commands look at it so the run's
+             * population, ranks, counters and random stream are left as they were.
+             */
+            [[nodiscard]] program evaluated_copy() const;
+            
+            /**
+             * Copies of up to n members of the front, picked at random, from the last ranked population. A generational program's current
+             * population is the next generation's offspring and is not ranked until it steps, so its previous population is used.
+             */
+            std::vector<individual> emigrants(size_t n);
+            
+            // a program with this one's parameters, objectives, criteria and modes that starts from its own random population
+            [[nodiscard]] std::unique_ptr<program> spawn_island(std::uint64_t seed) const;
+            
+            /**
+             * Takes in individuals evaluated by another program on the same instance. A ranked steady state population inserts them like
+             * offspring, otherwise they replace random members past the elites and are ranked with everyone else in the next step.
+             */
+            void accept_migrants(std::vector<individual>& migrants);
+            
+            // calls f with the policy of this program's objective
+            template<typename F>
+            inline void with_objective(F&& f)
+            {
+                switch (objective)
+                {
+                    case objective_mode::PARETO:
+                        f(pareto_objective{});
+                        break;
+                    case objective_mode::WEIGHTED_SUM:
+                        f(weighted_sum_objective{});
+                        break;
+                    case objective_mode::LEXICOGRAPHIC:
+                        f(lexicographic_objective{});
+                        break;
+                }
+            }
         
         protected:
             std::vector<route> constructRoute(const chromosome& c);
@@ -225,10 +440,13 @@ namespace ga
             
             void calculatePopulationFitness();
             
+            template<typename Objective>
             void rankPopulation();
             
+            template<typename Objective>
             void keepElites(population& pop, size_t n);
             
+            template<typename Objective>
             void applyCrossover(population& pop);
             
             void applyMutation(population& pop);
@@ -236,15 +454,16 @@ namespace ga
             void applySecondaryMutation(population& pop);
         
         public:
-            program(std::int32_t c, std::vector<record>&& r, bool usingFitness = false, std::int32_t popSize = DEFAULT_POPULATION_SIZE,
+            program(std::shared_ptr<const problem_instance> inst, objective_mode mode = objective_mode::PARETO, std::int32_t popSize = DEFAULT_POPULATION_SIZE,
                     std::int32_t genCount = DEFAULT_GENERATION_COUNT, std::int32_t tourSize = DEFAULT_TOURNAMENT_SIZE,
                     std::int32_t eliteCount = DEFAULT_ELITE_COUNT, double crossoverRate = DEFAULT_CROSSOVER_RATE,
-                    double mutationRate = DEFAULT_MUTATION_RATE, double mutation2Rate = DEFAULT_MUTATION_2_RATE):
-                    POPULATION_SIZE(popSize), GENERATION_COUNT(genCount), TOURNAMENT_SIZE(tourSize), ELITE_COUNT(eliteCount),
-                    CROSSOVER_RATE(crossoverRate), MUTATION_RATE(mutationRate), MUTATION2_RATE(mutationRate), using_fitness(usingFitness)
+                    double mutationRate = DEFAULT_MUTATION_RATE, double mutation2Rate = DEFAULT_MUTATION_2_RATE,
+                    std::uint64_t seed = random_engine::random_seed()):
+                    instance(std::move(inst)), capacity(instance->capacity), records(instance->records), engine(seed), POPULATION_SIZE(popSize),
+                    GENERATION_COUNT(genCount), TOURNAMENT_SIZE(tourSize), ELITE_COUNT(eliteCount), CROSSOVER_RATE(crossoverRate),
+                    MUTATION_RATE(mutationRate), MUTATION2_RATE(mutationRate), SEED(seed), objective(mode)
             {
-                capacity = c;
-                records = std::move(r);
+                generation_data = history_store({}, POPULATION_SIZE);
                 
                 current_population.pops.reserve(POPULATION_SIZE);
                 
@@ -252,8 +471,119 @@ namespace ga
                     current_population.pops.emplace_back(createRandomChromosome());
             }
             
+            program(std::int32_t c, std::vector<record>&& r, objective_mode mode = objective_mode::PARETO, std::int32_t popSize = DEFAULT_POPULATION_SIZE,
+                    std::int32_t genCount = DEFAULT_GENERATION_COUNT, std::int32_t tourSize = DEFAULT_TOURNAMENT_SIZE,
+                    std::int32_t eliteCount = DEFAULT_ELITE_COUNT, double crossoverRate = DEFAULT_CROSSOVER_RATE,
+                    double mutationRate = DEFAULT_MUTATION_RATE, double mutation2Rate = DEFAULT_MUTATION_2_RATE,
+                    std::uint64_t seed = random_engine::random_seed()):
+                    program(std::make_shared<const problem_instance>(c, std::move(r)), mode, popSize, genCount, tourSize, eliteCount,
+                            crossoverRate, mutationRate, mutation2Rate, seed)
+            {}
+            
+            /**
+             * Starts the twin of a program that has not run yet. The twin shares its instance, starts from the same population and draws the
+             * same random numbers, only the objective differs, so the two runs compare the objectives with common random numbers.
+             */
+            program(const program& twin, objective_mode mode);
+            
+            /**
+             * Restores a run saved with checkpoint(). Running the remaining generations gives the exact same results as a run that was never
+             * stopped, if the run was streaming its history the file is cut back to the checkpoint and appended to.
+             * Throws std::runtime_error if the file is not a readable checkpoint.
+             */
+            explicit program(const std::string& checkpoint_path);
+            
+            /**
+             * Saves the whole state of the run between two generations. The file is written next to the target and renamed over it so an
+             * existing checkpoint is never left half written.
+             * @return false if the file could not be written
+             */
+            bool checkpoint(const std::string& path);
+            
             void executeStep();
             
+            /**
+             * Checks the termination criteria, a run is done once this returns true. The reason is kept for stopReason().
+             */
+            bool finished();
+            
+            [[nodiscard]] stop_reason stopReason() const
+            {
+                return stopped;
+            }
+            
+            void setTermination(const termination_criteria& criteria)
+            {
+                termination = criteria;
+                stopped = stop_reason::NONE;
+            }
+            
+            [[nodiscard]] const termination_criteria& getTermination() const
+            {
+                return termination;
+            }
+            
+            // individuals evaluated so far
+            [[nodiscard]] std::uint64_t evaluations() const
+            {
+                return static_cast<std::uint64_t>(count) * static_cast<std::uint64_t>(POPULATION_SIZE);
+            }
+            
+            // wall clock seconds spent stepping, in executeStep or an async_runner
+            [[nodiscard]] double elapsed() const
+            {
+                return static_cast<double>(stepping_ns) / 1e9;
+            }
+            
+            // generations run when the archive or the best fitness last improved
+            [[nodiscard]] size_t lastImprovement() const
+            {
+                return last_improvement;
+            }
+            
+            [[nodiscard]] const pareto_archive& getArchive() const
+            {
+                return archive;
+            }
+            
+            // one point per generation that improved the archive, in order
+            [[nodiscard]] const std::vector<anytime_point>& getAnytimeTrace() const
+            {
+                return anytime_trace;
+            }
+            
+            // what the scratch arena handed out in each generation
+            [[nodiscard]] const std::vector<arena_stats>& getArenaHistory() const
+            {
+                return arena_history;
+            }
+            
+            /**
+             * Replaces every chromosome that is an exact copy of an earlier one of the same generation with a random one. The elites come
+             * first so they are always kept.
+             */
+            void setCloneImmigrants(bool enabled)
+            {
+                clone_immigrants = enabled;
+            }
+            
+            [[nodiscard]] bool getCloneImmigrants() const
+            {
+                return clone_immigrants;
+            }
+            
+            // decodes skipped because the chromosome had already been decoded, counted since the program was created or restored
+            [[nodiscard]] std::uint64_t clones() const
+            {
+                return clone_count;
+            }
+            
+            // clones replaced with random immigrants since the program was created or restored
+            [[nodiscard]] std::uint64_t immigrants() const
+            {
+                return immigrant_count;
+            }
+            
             void print();
             
             void validate();
@@ -271,6 +601,16 @@ namespace ga
                 return count;
             }
             
+            [[nodiscard]] const phase_profile& getProfile() const
+            {
+                return profile;
+            }
+            
+            [[nodiscard]] const op_counters& getCounters() const
+            {
+                return counters;
+            }
+            
             [[nodiscard]] std::vector<avg_point> getBestHistory() const
             {
                 return best_history;
@@ -281,48 +621,160 @@ namespace ga
                 return avg_history;
             }
             
+            /**
+             * Hypervolume of the (vehicles, distance) front of every evaluated generation against the instance's reference point
+             */
+            [[nodiscard]] const std::vector<double>& getHypervolumeHistory() const
+            {
+                return hypervolume_history;
+            }
+            
+            // hypervolume of the most recently evaluated generation, 0 before the first
+            [[nodiscard]] double getHypervolume() const
+            {
+                return hypervolume_history.empty() ? 0 : hypervolume_history.back();
+            }
+            
+            [[nodiscard]] const history_store& getHistory() const
+            {
+                return generation_data;
+            }
+            
+            /**
+             * Replaces the per individual history with an empty one using the given policy. The best points stay exact whatever is kept.
+             */
+            void setHistoryPolicy(history_config config)
+            {
+                generation_data = history_store(config, POPULATION_SIZE);
+            }
+            
+            /**
+             * Appends every generation from now on to a binary history file, independent of the in memory history policy
+             */
+            void streamHistory(const std::string& path, size_t generations_per_block = 32)
+            {
+                history_stream = std::make_unique<history_writer>(path, POPULATION_SIZE, generations_per_block);
+            }
+            
+            // flushes and closes the history file, if one is being written
+            void stopStreamingHistory()
+            {
+                history_stream = nullptr;
+            }
+            
+            /**
+             * Objectives the pareto ranking minimises, (vehicles, distance) unless changed. The weighted sum and lexicographic modes ignore it.
+             */
+            void setParetoObjectives(std::vector<objective_id> ids)
+            {
+                pareto_objectives = std::move(ids);
+            }
+            
+            [[nodiscard]] const std::vector<objective_id>& getParetoObjectives() const
+            {
+                return pareto_objectives;
+            }
+            
+            /**
+             * Generational unless changed, a running program can switch as its population is ranked again on the next step
+             */
+            void setStepMode(step_mode mode)
+            {
+                stepping = mode;
+                steady_state_ready = false;
+            }
+            
+            [[nodiscard]] step_mode getStepMode() const
+            {
+                return stepping;
+            }
+            
             [[nodiscard]] individual_point getBestDistance() const
             {
-                individual_point p{};
-                p.distance = std::numeric_limits<distance_t>::max();
-                for (const auto& v : generation_data)
-                    for (const auto& i : v.indv)
-                        if (i.distance < p.distance)
-                            p = i;
-                return p;
+                return best_distance;
             }
             
             [[nodiscard]] individual_point getBestCars() const
             {
-                individual_point p{};
-                p.routes = std::numeric_limits<size_t>::max();
-                for (const auto& v : generation_data)
-                    for (const auto& i : v.indv)
-                        if (i.routes < p.routes || (i.routes == p.routes && i.distance < p.distance))
-                            p = i;
-                return p;
+                return best_cars;
             }
             
             [[nodiscard]] individual_point getBestFitness() const
             {
-                individual_point p{};
-                p.fitness = std::numeric_limits<fitness_t>::max();
-                for (const auto& v : generation_data)
-                    for (const auto& i : v.indv)
-                        if (i.fitness < p.fitness)
-                            p = i;
-                return p;
+                return best_fitness;
+            }
+            
+            /**
+             * @return the distinct (vehicles, distance) points of rank 1 in the most recently evaluated generation, sorted by vehicles. Ranked on
+             * more than two objectives some of them may be dominated in (vehicles, distance).
+             */
+            [[nodiscard]] std::vector<individual_point> getParetoFront() const
+            {
+                std::vector<individual_point> front;
+                for (const auto& i : last_front)
+                {
+                    if (std::find_if(front.begin(), front.end(), [&i](const individual_point& p) {
+                        return p.routes == i.routes && p.distance == i.distance;
+                    }) == front.end())
+                        front.push_back(i);
+                }
+                std::sort(front.begin(), front.end(), [](const individual_point& a, const individual_point& b) {
+                    return a.routes < b.routes || (a.routes == b.routes && a.distance < b.distance);
+                });
+                return front;
             }
         
         private:
             size_t count = 0;
+            std::shared_ptr<const problem_instance> instance;
+            // shorthands into the shared instance
             std::int32_t capacity;
-            std::vector<record> records;
-            std::vector<generation_point> generation_data;
+            const std::vector<record>& records;
+            history_store generation_data;
+            // best points over every generation of the run, tracked as they are seen so they do not depend on the history policy
+            individual_point best_distance{std::numeric_limits<distance_t>::max()};
+            individual_point best_cars{0, 0, 0, std::numeric_limits<size_t>::max()};
+            individual_point best_fitness{0, std::numeric_limits<fitness_t>::max()};
+            std::vector<individual_point> last_front;
+            std::unique_ptr<history_writer> history_stream;
             std::vector<avg_point> best_history;
             std::vector<avg_point> avg_history;
+            std::vector<double> hypervolume_history;
+            // every non-dominated (vehicles, distance) point of the run
+            pareto_archive archive;
+            std::vector<anytime_point> anytime_trace;
+            // short lived buffers of the operators, released after every generation. Behind a pointer so programs stay movable
+            std::unique_ptr<scratch_arena> scratch = std::make_unique<scratch_arena>();
+            std::vector<arena_stats> arena_history;
+            size_t last_improvement = 0;
+            termination_criteria termination;
+            stop_reason stopped = stop_reason::NONE;
             population current_population;
+            // the population decoded last generation, its routes are reused by any chromosome that survived unchanged
+            population previous_population;
+            // clone detection, hash to the first individual decoded with that hash this generation and last, the buckets are reused
+            std::unordered_map<std::uint64_t, const individual*> decoded, previous_decoded;
+            bool clone_immigrants = false;
+            std::uint64_t clone_count = 0;
+            std::uint64_t immigrant_count = 0;
             random_engine engine;
+            phase_profile profile;
+            op_counters counters;
+            // pareto ranking buffers, kept between generations
+            objective_matrix objective_values;
+            non_dominated_sorter sorter;
+            std::vector<rank_t> ranks;
+            std::vector<std::pair<double, double>> front_points;
+            // steady state, the ranks above follow the population and the fronts are updated one offspring at a time
+            step_mode stepping = step_mode::GENERATIONAL;
+            bool steady_state_ready = false;
+            // the current population is decoded and evaluated, from the first steady state step until a generational step or a reset
+            bool population_evaluated = false;
+            incremental_fronts fronts;
+            std::uint64_t stepping_ns = 0;
+            std::chrono::steady_clock::time_point step_start;
+            std::vector<double> offspring_values;
+            population offspring;
         public:
             const std::int32_t POPULATION_SIZE;
             const std::int32_t GENERATION_COUNT;
@@ -331,7 +783,10 @@ namespace ga
             const double CROSSOVER_RATE;
             const double MUTATION_RATE;
             const double MUTATION2_RATE;
-            bool using_fitness = false;
+            const std::uint64_t SEED;
+            const objective_mode objective = objective_mode::PARETO;
+        private:
+            std::vector<objective_id> pareto_objectives = default_objectives();
     };
     
     template<typename T>
@@ -0,0 +1,125 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_STATS_H
+#define INC_2006_VRPTW_PARETO_STATS_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ga
+{
+
+    /**
+     * two sided 95% critical value of Student's t distribution
+     */
+    double t_critical(double df);
+
+    /**
+     * P² estimate of one quantile (Jain and Chlamtac 1985), constant memory however many values are added. Exact up to five values.
+     */
+    class p2_quantile
+    {
+        public:
+            explicit p2_quantile(double p);
+
+            void add(double x);
+
+            [[nodiscard]] double value() const;
+
+        private:
+            double p;
+            size_t n = 0;
+            // marker heights, positions and desired positions
+            std::array<double, 5> q{};
+            std::array<double, 5> pos{};
+            std::array<double, 5> desired{};
+            std::array<double, 5> increment{};
+    };
+
+    /**
+     * Count, Welford mean and variance, min, max and the 10th, 50th and 90th percentiles of a stream of values
+     */
+    class running_stats
+    {
+        public:
+            void add(double x);
+
+            [[nodiscard]] size_t count() const
+            {
+                return n;
+            }
+
+            [[nodiscard]] double mean() const
+            {
+                return m;
+            }
+
+            // sample variance
+            [[nodiscard]] double variance() const
+            {
+                return n > 1 ? m2 / static_cast<double>(n - 1) : 0;
+            }
+
+            [[nodiscard]] double stddev() const;
+
+            [[nodiscard]] double min() const
+            {
+                return lo;
+            }
+
+            [[nodiscard]] double max() const
+            {
+                return hi;
+            }
+
+            [[nodiscard]] double p10() const
+            {
+                return q10.value();
+            }
+
+            [[nodiscard]] double median() const
+            {
+                return q50.value();
+            }
+
+            [[nodiscard]] double p90() const
+            {
+                return q90.value();
+            }
+
+            /**
+             * half width of the 95% confidence interval of the mean, infinite below two values
+             */
+            [[nodiscard]] double ci_half_width() const;
+
+            /**
+             * ci_half_width() relative to the mean. A zero mean only counts as settled once there is no spread at all.
+             */
+            [[nodiscard]] double relative_ci() const;
+
+            static void writeCSVHeader(std::ostream& out);
+
+            void writeCSV(std::ostream& out, const std::string& label, const std::string& name) const;
+
+        private:
+            size_t n = 0;
+            double m = 0;
+            double m2 = 0;
+            double lo = std::numeric_limits<double>::infinity();
+            double hi = -std::numeric_limits<double>::infinity();
+            p2_quantile q10{0.1};
+            p2_quantile q50{0.5};
+            p2_quantile q90{0.9};
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_STATS_H
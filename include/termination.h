@@ -0,0 +1,61 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_TERMINATION_H
+#define INC_2006_VRPTW_PARETO_TERMINATION_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace ga
+{
+
+    enum class stop_reason : std::uint8_t
+    {
+        // still running
+        NONE = 0,
+        GENERATIONS = 1,
+        STAGNATION = 2,
+        TIME = 3,
+        EVALUATIONS = 4
+    };
+
+    std::string_view to_string(stop_reason reason);
+
+    /**
+     * When a run stops, the first criterion met wins. Every criterion but the generation count is off at 0 and any combination can be on.
+     */
+    struct termination_criteria
+    {
+        // 0 runs the program's GENERATION_COUNT
+        std::uint64_t generations = 0;
+        // stop once neither the pareto archive nor the best weighted sum fitness has improved for this many generations
+        std::uint64_t stagnation = 0;
+        // seconds spent inside executeStep, so a checkpointed run keeps its budget across restarts
+        double time_budget = 0;
+        // individuals evaluated, the population size per generation
+        std::uint64_t evaluation_budget = 0;
+    };
+    
+    /**
+     * State of the pareto archive at the moment it improved, the anytime quality curve of a run is the list of these
+     */
+    struct anytime_point
+    {
+        // seconds spent inside executeStep, the same clock as the time budget
+        double seconds = 0;
+        std::uint64_t evaluations = 0;
+        // the archived point with the fewest vehicles
+        double vehicles = 0;
+        double vehicles_distance = 0;
+        // shortest distance of any archived point
+        double distance = 0;
+        double hypervolume = 0;
+    };
+
+}
+
+#endif //INC_2006_VRPTW_PARETO_TERMINATION_H
@@ -0,0 +1,76 @@
+#pragma once
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+
+#ifndef INC_2006_VRPTW_PARETO_TRACE_H
+#define INC_2006_VRPTW_PARETO_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/**
+ * Chrome trace-event (chrome://tracing, Perfetto) timeline recording.
+ * Every thread appends into its own buffer so recording never takes a lock, the buffers are only read by flush().
+ */
+namespace ga::trace
+{
+    using clock = std::chrono::steady_clock;
+
+    namespace detail
+    {
+        extern std::atomic_bool active;
+    }
+
+    /**
+     * Starts recording, the timeline is written to path by flush() and again when the process exits.
+     */
+    void enable(const std::string& path);
+
+    [[nodiscard]] inline bool enabled()
+    {
+        return detail::active.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Names the calling thread's track in the viewer
+     */
+    void set_thread_name(const std::string& name);
+
+    void record(const std::string& name, const char* category, clock::time_point start, clock::time_point end);
+
+    /**
+     * Writes every span recorded so far. Must not race with threads that are still recording.
+     */
+    void flush();
+
+    /**
+     * Records the enclosing scope as a span on the calling thread
+     */
+    class span
+    {
+        private:
+            std::string name;
+            const char* category;
+            clock::time_point start;
+            bool recording;
+        public:
+            span(std::string name, const char* category):
+                    name(std::move(name)), category(category), start(clock::now()), recording(enabled())
+            {}
+
+            span(const span&) = delete;
+
+            span& operator=(const span&) = delete;
+
+            ~span()
+            {
+                if (recording)
+                    record(name, category, start, clock::now());
+            }
+    };
+}
+
+#endif //INC_2006_VRPTW_PARETO_TRACE_H
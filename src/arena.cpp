@@ -0,0 +1,57 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <arena.h>
+
+namespace ga
+{
+    void* counting_resource::do_allocate(size_t bytes, size_t alignment)
+    {
+        allocation_count++;
+        byte_count += bytes;
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void counting_resource::do_deallocate(void* p, size_t bytes, size_t alignment)
+    {
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool counting_resource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    scratch_arena::scratch_arena():
+            initial(new std::byte[INITIAL_BYTES]), upstream(std::pmr::new_delete_resource()),
+            monotonic(initial.get(), INITIAL_BYTES, &upstream), front(&monotonic)
+    {}
+
+    arena_stats scratch_arena::release()
+    {
+        monotonic.release();
+        arena_stats total{front.allocations(), front.bytes(), upstream.allocations(), upstream.bytes()};
+        arena_stats since{total.allocations - released.allocations, total.bytes - released.bytes,
+                          total.upstream_allocations - released.upstream_allocations, total.upstream_bytes - released.upstream_bytes};
+        released = total;
+        return since;
+    }
+
+    void writeArenaCSV(std::ostream& out, const std::vector<arena_stats>& generations)
+    {
+        out << "generation,allocations,bytes,upstream_allocations,upstream_bytes\n";
+        arena_stats total;
+        for (size_t i = 0; i < generations.size(); i++)
+        {
+            const auto& g = generations[i];
+            out << i << ',' << g.allocations << ',' << g.bytes << ',' << g.upstream_allocations << ',' << g.upstream_bytes << '\n';
+            total.allocations += g.allocations;
+            total.bytes += g.bytes;
+            total.upstream_allocations += g.upstream_allocations;
+            total.upstream_bytes += g.upstream_bytes;
+        }
+        out << "total," << total.allocations << ',' << total.bytes << ',' << total.upstream_allocations << ',' << total.upstream_bytes << '\n';
+    }
+
+}
@@ -0,0 +1,164 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <async.h>
+#include <blt/std/logging.h>
+#include <algorithm>
+
+namespace ga
+{
+    async_runner::async_runner(program& master, async_options options): master(master), options(options)
+    {
+        this->options.producers = std::max<size_t>(this->options.producers, 1);
+        this->options.evaluators = std::max<size_t>(this->options.evaluators, 1);
+        if (this->options.snapshot_every == 0)
+            this->options.snapshot_every = std::max<size_t>(static_cast<size_t>(master.POPULATION_SIZE) / 4, 1);
+    }
+
+    void async_runner::run(std::uint64_t generations)
+    {
+        if (master.stepping != step_mode::STEADY_STATE)
+        {
+            BLT_INFO("The async runner replaces the population steady state, switching the program over");
+            master.setStepMode(step_mode::STEADY_STATE);
+        }
+        master.with_objective([this, generations](auto policy) { run<decltype(policy)>(generations); });
+    }
+
+    template<typename Objective>
+    void async_runner::run(std::uint64_t generations)
+    {
+        master.step_start = std::chrono::steady_clock::now();
+        master.prepare_steady_state<Objective>();
+        master.stepping_ns += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - master.step_start).count());
+
+        bred = std::make_unique<mpmc_queue<individual>>(options.queue_capacity);
+        scored = std::make_unique<mpmc_queue<individual>>(options.queue_capacity);
+        stopping = false;
+        publish();
+
+        // every worker gets its own stream, derived from the master's seed and where the run is so a resumed run does not repeat one
+        std::vector<std::unique_ptr<program>> workers;
+        for (size_t i = 0; i < options.producers + options.evaluators; i++)
+            workers.push_back(std::unique_ptr<program>(new program(master, master.SEED ^ ((i + 1) * 0x9E3779B97F4A7C15ull + master.count))));
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < options.producers; i++)
+            threads.emplace_back([this, &worker = *workers[i]]() { produce<Objective>(worker); });
+        for (size_t i = options.producers; i < workers.size(); i++)
+            threads.emplace_back([this, &worker = *workers[i]]() { evaluate(worker); });
+
+        individual child;
+        for (std::uint64_t g = 0; g < generations && !master.finished(); g++)
+        {
+            master.step_start = std::chrono::steady_clock::now();
+            {
+                phase_timer timer(master.profile, phase::HISTORY);
+                master.add_step_to_history();
+            }
+            for (std::int32_t integrated = 0; integrated < master.POPULATION_SIZE;)
+            {
+                if (!scored->try_pop(child))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // the evaluators' populations are stale snapshots, clones are looked for in the live one. Only a replaced clone is
+                // decoded here, the others were decoded by the evaluator already
+                if (master.replace_clone(child))
+                    master.evaluate_offspring(child);
+                master.archive_offspring(child);
+                {
+                    phase_timer timer(master.profile, phase::RANK);
+                    master.insert_offspring<Objective>(std::move(child));
+                }
+                if (++integrated % static_cast<std::int32_t>(options.snapshot_every) == 0)
+                    publish();
+            }
+            master.finish_steady_state_generation<Objective>();
+            master.stepping_ns += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - master.step_start).count());
+            master.arena_history.push_back(master.scratch->release());
+        }
+
+        stopping = true;
+        for (auto& t : threads)
+            t.join();
+        for (const auto& worker : workers)
+        {
+            master.profile.merge(worker->profile);
+            master.counters += worker->counters;
+        }
+        bred.reset();
+        scored.reset();
+        snapshot.reset();
+    }
+
+    template<typename Objective>
+    void async_runner::produce(program& worker)
+    {
+        std::uint64_t seen = 0;
+        while (!stopping)
+        {
+            if (auto latest_population = latest(seen))
+                worker.current_population = *latest_population;
+            worker.offspring.pops.clear();
+            worker.breed_offspring<Objective>(worker.offspring);
+            // workers have no generations of their own, their scratch is dropped after every batch
+            worker.scratch->release();
+            for (auto& child : worker.offspring.pops)
+            {
+                while (!bred->try_push(child))
+                {
+                    if (stopping)
+                        return;
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    void async_runner::evaluate(program& worker)
+    {
+        individual child;
+        while (!stopping)
+        {
+            if (!bred->try_pop(child))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            worker.evaluate_offspring(child);
+            worker.scratch->release();
+            while (!scored->try_push(child))
+            {
+                if (stopping)
+                    return;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void async_runner::publish()
+    {
+        auto next = std::make_shared<const population>(master.current_population);
+        {
+            std::scoped_lock lock(snapshot_mutex);
+            snapshot = std::move(next);
+        }
+        snapshot_version.fetch_add(1, std::memory_order_release);
+    }
+
+    std::shared_ptr<const population> async_runner::latest(std::uint64_t& seen)
+    {
+        const auto version = snapshot_version.load(std::memory_order_acquire);
+        if (version == seen)
+            return nullptr;
+        std::scoped_lock lock(snapshot_mutex);
+        seen = version;
+        return snapshot;
+    }
+
+}
@@ -0,0 +1,1068 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <batch.h>
+#include <cache.h>
+#include <stats.h>
+#include <program.h>
+#include <hash.h>
+#include <trace.h>
+#include <numa.h>
+#include <blt/std/logging.h>
+#include <blt/std/string.h>
+#include <blt/std/format.h>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace blt
+{
+    inline std::string filename(const std::string& path)
+    {
+        auto paths = blt::string::split(path, "/");
+        auto final = paths[paths.size() - 1];
+        if (final == "/")
+            return paths[paths.size() - 2];
+        return final;
+    }
+}
+
+namespace ga
+{
+    static constexpr auto JOURNAL_HEADER = "# VRPTW batch journal v1";
+
+    static void write_point(std::ostream& out, const individual_point& p)
+    {
+        out << ',' << p.distance << ',' << p.fitness << ',' << p.rank << ',' << p.routes;
+    }
+
+    static std::string format_result(const run_result& r)
+    {
+        std::ostringstream line;
+        line << std::setprecision(std::numeric_limits<double>::max_digits10);
+        line << r.job << ',' << r.instance << ',' << r.capacity << ',' << r.run << ',' << std::hex << r.work << std::dec << ','
+             << r.seconds;
+        write_point(line, r.best_cars);
+        write_point(line, r.best_distance);
+        write_point(line, r.best_fitness);
+        for (auto v : r.counters.values)
+            line << ',' << v;
+        for (const auto& t : r.profile.phases)
+            line << ',' << t.samples << ',' << t.total_ns << ',' << t.min_ns << ',' << t.max_ns;
+        line << ',' << r.hypervolume << ',' << r.generations << ',' << static_cast<int>(r.stopped) << ','
+             << r.hypervolume_target_seconds << ',' << r.hypervolume_target_evaluations << ',' << r.known_target_seconds << ','
+             << r.evaluations;
+        return line.str();
+    }
+
+    static bool parse_result(const std::string& line, run_result& r)
+    {
+        auto split = line.find_last_of(',');
+        if (split == std::string::npos)
+            return false;
+        auto body = line.substr(0, split);
+        std::ostringstream hash;
+        hash << std::hex << fnv1a(body);
+        if (line.substr(split + 1) != hash.str())
+            return false;
+
+        auto fields = blt::string::split(body, ',');
+        constexpr size_t expected = 6 + 3 * 4 + static_cast<size_t>(counter::COUNT) + static_cast<size_t>(phase::COUNT) * 4 + 7;
+        if (fields.size() != expected)
+            return false;
+        try
+        {
+            size_t i = 0;
+            r.job = fields[i++];
+            r.instance = fields[i++];
+            r.capacity = std::stoi(fields[i++]);
+            r.run = std::stoull(fields[i++]);
+            r.work = std::stoull(fields[i++], nullptr, 16);
+            r.seconds = std::stod(fields[i++]);
+            for (auto* p : {&r.best_cars, &r.best_distance, &r.best_fitness})
+            {
+                p->distance = std::stod(fields[i++]);
+                p->fitness = std::stod(fields[i++]);
+                p->rank = std::stoi(fields[i++]);
+                p->routes = std::stoull(fields[i++]);
+            }
+            for (auto& v : r.counters.values)
+                v = std::stoull(fields[i++]);
+            for (auto& t : r.profile.phases)
+            {
+                t.samples = std::stoull(fields[i++]);
+                t.total_ns = std::stoull(fields[i++]);
+                t.min_ns = std::stoull(fields[i++]);
+                t.max_ns = std::stoull(fields[i++]);
+            }
+            r.hypervolume = std::stod(fields[i++]);
+            r.generations = std::stoull(fields[i++]);
+            auto stopped = std::stoi(fields[i++]);
+            if (stopped < 0 || stopped > static_cast<int>(stop_reason::EVALUATIONS))
+                return false;
+            r.stopped = static_cast<stop_reason>(stopped);
+            r.hypervolume_target_seconds = std::stod(fields[i++]);
+            r.hypervolume_target_evaluations = std::stoull(fields[i++]);
+            r.known_target_seconds = std::stod(fields[i++]);
+            r.evaluations = std::stoull(fields[i++]);
+        } catch (const std::exception&)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    batch_journal::batch_journal(const std::string& path)
+    {
+        bool torn = false;
+        {
+            std::ifstream in(path);
+            std::string line;
+            size_t dropped = 0;
+            while (std::getline(in, line))
+            {
+                // only the last line can be missing its newline, and only if the process died writing it
+                torn = in.eof();
+                if (line.empty() || line[0] == '#')
+                    continue;
+                run_result r;
+                if (!parse_result(line, r))
+                {
+                    dropped++;
+                    continue;
+                }
+                keys.insert(key(r.job, r.instance, r.work, r.run));
+                entries.push_back(std::move(r));
+            }
+            if (!entries.empty() || dropped > 0)
+                BLT_INFO("Journal %s has %d finished runs, dropped %d damaged lines", path.c_str(), entries.size(), dropped);
+        }
+        bool exists = std::filesystem::exists(path);
+        out.open(path, std::ios::app);
+        if (!out.is_open())
+            BLT_ERROR("Unable to open batch journal %s, results will not survive a crash", path.c_str());
+        if (torn)
+            out << '\n';
+        if (!exists)
+            out << JOURNAL_HEADER << '\n';
+        out.flush();
+    }
+
+    std::string batch_journal::key(const std::string& job, const std::string& instance, std::uint64_t work, std::uint64_t run)
+    {
+        return job + ' ' + instance + ' ' + std::to_string(work) + ' ' + std::to_string(run);
+    }
+
+    bool batch_journal::contains(const std::string& job, const std::string& instance, std::uint64_t work, std::uint64_t run)
+    {
+        std::scoped_lock l(lock);
+        return keys.contains(key(job, instance, work, run));
+    }
+
+    void batch_journal::append(const run_result& result)
+    {
+        auto line = format_result(result);
+        std::ostringstream hash;
+        hash << std::hex << fnv1a(line);
+        std::scoped_lock l(lock);
+        out << line << ',' << hash.str() << '\n';
+        out.flush();
+        keys.insert(key(result.job, result.instance, result.work, result.run));
+        entries.push_back(result);
+    }
+
+    std::vector<run_result> batch_journal::results()
+    {
+        std::scoped_lock l(lock);
+        return entries;
+    }
+
+    size_t batch_journal::size()
+    {
+        std::scoped_lock l(lock);
+        return entries.size();
+    }
+
+    std::uint64_t batch_params::journal_work() const
+    {
+        return fnv1a(work_key(), fnv1a(SOLVER_VERSION));
+    }
+
+    std::string batch_params::work_key() const
+    {
+        std::ostringstream key;
+        key << std::setprecision(std::numeric_limits<double>::max_digits10);
+        key << capacity << ' ' << generations << ' ' << population << ' ' << tournament << ' ' << elite << ' ' << crossover << ' '
+            << mutation << ' ' << mutation2 << ' ' << to_string(objective) << ' ' << to_string(pareto_objectives) << ' ' << paired << ' '
+            << to_string(stepping) << ' ' << immigrants << ' ' << termination.generations << ' ' << termination.stagnation << ' '
+            << termination.time_budget << ' ' << termination.evaluation_budget << ' ';
+        if (seed)
+            key << *seed;
+        else
+            key << "random";
+        return key.str();
+    }
+
+    std::vector<batch_job> load_manifest(const std::string& path)
+    {
+        std::ifstream input(path);
+        if (!input.is_open())
+        {
+            BLT_ERROR("Unable to open batch manifest %s", path.c_str());
+            return {};
+        }
+        const auto directory = std::filesystem::path(path).parent_path();
+
+        batch_params defaults;
+        std::vector<batch_job> jobs;
+        std::string line;
+        size_t line_number = 0;
+        while (std::getline(input, line))
+        {
+            line_number++;
+            if (auto comment = line.find('#'); comment != std::string::npos)
+                line.erase(comment);
+            std::istringstream stream(line);
+            std::string key;
+            if (!(stream >> key))
+                continue;
+            std::vector<std::string> values{std::istream_iterator<std::string>(stream), std::istream_iterator<std::string>()};
+            if (values.empty())
+            {
+                BLT_ERROR("%s:%d: '%s' needs a value", path.c_str(), line_number, key.c_str());
+                return {};
+            }
+
+            if (key == "job")
+            {
+                if (values[0].find(',') != std::string::npos)
+                {
+                    BLT_ERROR("%s:%d: job names can not contain ','", path.c_str(), line_number);
+                    return {};
+                }
+                jobs.push_back({values[0], defaults, {}});
+                continue;
+            }
+            // before the first job every key is a default
+            auto& params = jobs.empty() ? defaults : jobs.back().params;
+            try
+            {
+                if (key == "instances")
+                {
+                    if (jobs.empty())
+                    {
+                        BLT_ERROR("%s:%d: instances must belong to a job", path.c_str(), line_number);
+                        return {};
+                    }
+                    for (const auto& v : values)
+                    {
+                        auto instance = std::filesystem::path(v);
+                        jobs.back().instances.push_back(instance.is_absolute() ? v : (directory / instance).string());
+                    }
+                } else if (key == "runs")
+                    params.runs = std::stoul(values[0]);
+                else if (key == "capacity")
+                    params.capacity = std::stoi(values[0]);
+                else if (key == "generations")
+                    params.generations = std::stoi(values[0]);
+                else if (key == "population")
+                    params.population = std::stoi(values[0]);
+                else if (key == "tournament")
+                    params.tournament = std::stoi(values[0]);
+                else if (key == "elite")
+                    params.elite = std::stoi(values[0]);
+                else if (key == "crossover")
+                    params.crossover = std::stod(values[0]);
+                else if (key == "mutation")
+                    params.mutation = std::stod(values[0]);
+                else if (key == "mutation2")
+                    params.mutation2 = std::stod(values[0]);
+                else if (key == "objective")
+                {
+                    if (!parse_objective(values[0], params.objective))
+                        throw std::invalid_argument(values[0]);
+                } else if (key == "pareto_objectives")
+                {
+                    if (!parse_objectives(values[0], params.pareto_objectives))
+                        throw std::invalid_argument(values[0]);
+                } else if (key == "fitness")
+                    params.objective = std::stoi(values[0]) != 0 ? objective_mode::WEIGHTED_SUM : objective_mode::PARETO;
+                else if (key == "paired")
+                    params.paired = std::stoi(values[0]) != 0;
+                else if (key == "step_mode")
+                {
+                    if (!parse_step_mode(values[0], params.stepping))
+                        throw std::invalid_argument(values[0]);
+                } else if (key == "immigrants")
+                    params.immigrants = std::stoi(values[0]) != 0;
+                else if (key == "stagnation")
+                    params.termination.stagnation = std::stoull(values[0]);
+                else if (key == "time_budget")
+                    params.termination.time_budget = std::stod(values[0]);
+                else if (key == "deadline")
+                {
+                    // the generation count no longer stops the run, only the clock (or another criterion) does
+                    params.termination.time_budget = std::stod(values[0]);
+                    params.termination.generations = std::numeric_limits<std::uint64_t>::max();
+                } else if (key == "evaluation_budget")
+                    params.termination.evaluation_budget = std::stoull(values[0]);
+                else if (key == "seed")
+                    params.seed = std::stoull(values[0]);
+                else
+                    BLT_WARN("%s:%d: unknown key '%s' ignored", path.c_str(), line_number, key.c_str());
+            } catch (const std::exception&)
+            {
+                BLT_ERROR("%s:%d: '%s' is not a valid value for %s", path.c_str(), line_number, values[0].c_str(), key.c_str());
+                return {};
+            }
+        }
+        return jobs;
+    }
+
+    std::vector<batch_task> schedule_tasks(const std::vector<batch_job>& jobs)
+    {
+        std::vector<batch_task> tasks;
+        std::unordered_map<std::string, size_t> work;
+        for (const auto& job : jobs)
+        {
+            for (const auto& problem : job.instances)
+            {
+                auto instance = blt::filename(problem);
+                auto key = instance + ' ' + job.params.work_key();
+                if (auto found = work.find(key); found != work.end())
+                {
+                    auto& existing = tasks[found->second];
+                    BLT_INFO("%s in job %s is already run by job %s", instance.c_str(), job.name.c_str(), existing.job.c_str());
+                    existing.params.runs = std::max(existing.params.runs, job.params.runs);
+                    continue;
+                }
+                work[key] = tasks.size();
+                tasks.push_back({job.name, problem, instance, job.params, instance + " " + std::to_string(job.params.capacity), 0});
+            }
+        }
+
+        std::unordered_map<std::string, size_t> labels;
+        for (const auto& t : tasks)
+            labels[t.label]++;
+        for (auto& t : tasks)
+        {
+            if (labels[t.label] > 1)
+                t.label = t.job + " " + t.label;
+
+            // decoding dominates a generation, and inserting a customer walks a route whose length grows with the capacity until every
+            // customer fits in one vehicle
+            auto records = load_problem(t.problem);
+            if (records.size() < 2)
+            {
+                BLT_WARN("%s has no customers, skipping it", t.problem.c_str());
+                t.expected_cost = -1;
+                continue;
+            }
+            double demand = 0;
+            for (size_t i = 1; i < records.size(); i++)
+                demand += records[i].demand;
+            auto customers = static_cast<double>(records.size() - 1);
+            auto route_length = demand <= 0 ? customers : std::min(customers, t.params.capacity / (demand / customers));
+            t.expected_cost = static_cast<double>(t.params.runs) * t.params.generations * t.params.population * customers * route_length;
+        }
+        std::erase_if(tasks, [](const batch_task& t) {
+            return t.expected_cost < 0;
+        });
+        // stable so equal tasks keep their manifest order
+        std::stable_sort(tasks.begin(), tasks.end(), [](const batch_task& a, const batch_task& b) {
+            return a.expected_cost > b.expected_cost;
+        });
+        return tasks;
+    }
+
+    /**
+     * Reads the times to target off the run's anytime trace
+     */
+    static void measure_targets(run_result& r, const std::unordered_map<std::string, best_known>& known, double gap)
+    {
+        r.hypervolume_target_seconds = std::numeric_limits<double>::quiet_NaN();
+        r.hypervolume_target_evaluations = 0;
+        r.known_target_seconds = std::numeric_limits<double>::quiet_NaN();
+        if (r.anytime.empty())
+            return;
+        // the archive only grows, so its final hypervolume is the largest of the trace
+        const auto target = r.anytime.back().hypervolume * HYPERVOLUME_TARGET;
+        for (const auto& v : r.anytime)
+        {
+            if (v.hypervolume >= target)
+            {
+                r.hypervolume_target_seconds = v.seconds;
+                r.hypervolume_target_evaluations = v.evaluations;
+                break;
+            }
+        }
+        auto bks = known.find(std::filesystem::path(r.instance).stem().string());
+        if (bks == known.end())
+            return;
+        for (const auto& v : r.anytime)
+        {
+            if (v.vehicles <= bks->second.vehicles && v.vehicles_distance <= bks->second.distance * (1 + gap))
+            {
+                r.known_target_seconds = v.seconds;
+                break;
+            }
+        }
+    }
+
+    static std::string run_name(const batch_task& task, size_t run)
+    {
+        return task.job + "_" + task.instance + "_" + std::to_string(task.params.capacity) + "_" + std::to_string(run);
+    }
+
+    /**
+     * @param instance the task's instance, loaded here if null
+     */
+    static run_result execute_run(const batch_options& options, const batch_task& task, size_t run,
+                                  std::shared_ptr<const ga::problem_instance> instance)
+    {
+        ga::trace::span run_span(task.label + " run " + std::to_string(run), "run");
+        const auto name = run_name(task, run);
+        const auto& params = task.params;
+        // the weighted sum twin of a paired run is checkpointed and streamed next to the pareto run
+        const auto checkpoint_file = options.checkpoint_dir + "/" + name + ".ckpt";
+        const auto twin_checkpoint_file = options.checkpoint_dir + "/" + name + "_wsum.ckpt";
+        const bool resuming = options.checkpoint_every > 0 && std::filesystem::exists(checkpoint_file) &&
+                              (!params.paired || std::filesystem::exists(twin_checkpoint_file));
+
+        std::unique_ptr<ga::program> p;
+        std::unique_ptr<ga::program> twin;
+        if (resuming)
+        {
+            try
+            {
+                p = std::make_unique<ga::program>(checkpoint_file);
+                if (params.paired)
+                    twin = std::make_unique<ga::program>(twin_checkpoint_file);
+                BLT_INFO("Resuming %s from generation %d", name.c_str(), p->steps());
+            } catch (const std::runtime_error& e)
+            {
+                BLT_WARN("%s, starting the run again", e.what());
+                p = nullptr;
+                twin = nullptr;
+            }
+        }
+        if (!p)
+        {
+            if (!instance)
+                instance = std::make_shared<const ga::problem_instance>(params.capacity, load_problem(task.problem));
+            p = std::make_unique<ga::program>(instance, params.paired ? objective_mode::PARETO : params.objective, params.population,
+                                              params.generations, params.tournament, params.elite, params.crossover, params.mutation,
+                                              params.mutation2, params.seed ? *params.seed + run : random_engine::random_seed());
+            p->setHistoryPolicy(options.history);
+            p->setParetoObjectives(params.pareto_objectives);
+            p->setTermination(params.termination);
+            p->setCloneImmigrants(params.immigrants);
+            p->setStepMode(params.stepping);
+            if (params.paired)
+                twin = std::make_unique<ga::program>(*p, objective_mode::WEIGHTED_SUM);
+            if (!options.stream_path.empty())
+            {
+                p->streamHistory(options.stream_path + "_" + name + ".vrph");
+                if (twin)
+                    twin->streamHistory(options.stream_path + "_" + name + "_wsum.vrph");
+            }
+        }
+
+        auto run_start = std::chrono::steady_clock::now();
+        // each of the pair stops on its own criteria, the one still running carries on alone
+        size_t generation = std::max(p->steps(), twin ? twin->steps() : 0);
+        while (!p->finished() || (twin && !twin->finished()))
+        {
+            if (!p->finished())
+                p->executeStep();
+            if (twin && !twin->finished())
+                twin->executeStep();
+            generation++;
+            if (options.checkpoint_every > 0 && generation % options.checkpoint_every == 0)
+            {
+                p->checkpoint(checkpoint_file);
+                if (twin)
+                    twin->checkpoint(twin_checkpoint_file);
+            }
+        }
+        BLT_TRACE("%s stopped on %s after %d generations", name.c_str(), std::string(to_string(p->stopReason())).c_str(), p->steps());
+
+        run_result result;
+        result.job = task.job;
+        result.instance = task.instance;
+        result.capacity = params.capacity;
+        result.run = run;
+        result.work = params.journal_work();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+        result.best_cars = p->getBestCars();
+        result.best_distance = p->getBestDistance();
+        // the wGA column comes from the weighted sum twin when there is one
+        result.best_fitness = twin ? twin->getBestFitness() : p->getBestFitness();
+        result.counters = p->getCounters();
+        result.profile = p->getProfile();
+        if (twin)
+        {
+            result.counters += twin->getCounters();
+            result.profile.merge(twin->getProfile());
+        }
+        result.front = p->getParetoFront();
+        result.hypervolume = p->getHypervolume();
+        result.generations = p->steps();
+        result.stopped = p->stopReason();
+        result.evaluations = p->evaluations() + (twin ? twin->evaluations() : 0);
+        result.anytime = p->getAnytimeTrace();
+        return result;
+    }
+
+    /**
+     * Streaming aggregate of every objective the tables report for one task
+     */
+    struct task_stats
+    {
+        static constexpr std::array<const char*, 7> NAMES{
+                "wga_vehicles", "wga_distance", "pga_vehicles", "pga_vehicles_distance", "pga_distance_vehicles", "pga_distance",
+                "pga_hypervolume"
+        };
+
+        std::array<running_stats, NAMES.size()> objectives;
+
+        void add(const run_result& r)
+        {
+            objectives[0].add(static_cast<double>(r.best_fitness.routes));
+            objectives[1].add(r.best_fitness.distance);
+            objectives[2].add(static_cast<double>(r.best_cars.routes));
+            objectives[3].add(r.best_cars.distance);
+            objectives[4].add(static_cast<double>(r.best_distance.routes));
+            objectives[5].add(r.best_distance.distance);
+            if (!std::isnan(r.hypervolume))
+                objectives[6].add(r.hypervolume);
+        }
+
+        [[nodiscard]] size_t count() const
+        {
+            return objectives[0].count();
+        }
+
+        // the widest relative 95% confidence interval of any objective
+        [[nodiscard]] double widest_ci() const
+        {
+            double widest = 0;
+            for (const auto& o : objectives)
+            {
+                // a run that never ranked a generation has no hypervolume
+                if (o.count() > 0)
+                    widest = std::max(widest, o.relative_ci());
+            }
+            return widest;
+        }
+
+        [[nodiscard]] bool settled(const batch_options& options) const
+        {
+            return options.ci_target > 0 && count() >= std::max<size_t>(2, options.ci_min_runs) && widest_ci() <= options.ci_target;
+        }
+    };
+
+    void run_batch(const batch_options& options)
+    {
+        const auto tasks = schedule_tasks(load_manifest(options.manifest_path));
+        if (tasks.empty())
+        {
+            BLT_ERROR("Nothing to run in %s", options.manifest_path.c_str());
+            return;
+        }
+
+        batch_journal journal(options.journal_path);
+        const result_cache cache(options.cache_dir);
+        const auto known = load_best_known(options.known_path);
+
+        struct work_unit
+        {
+            size_t task;
+            size_t run;
+            // cache key, only seeded runs have one
+            std::optional<std::uint64_t> key;
+        };
+
+        // journaled results only count for a task with the same settings run by the same solver version
+        std::vector<std::uint64_t> works;
+        std::unordered_map<std::string, size_t> task_index;
+        for (size_t t = 0; t < tasks.size(); t++)
+        {
+            works.push_back(tasks[t].params.journal_work());
+            task_index[tasks[t].job + " " + tasks[t].instance + " " + std::to_string(works.back())] = t;
+        }
+        auto journaled_task = [&](const run_result& r) -> std::optional<size_t> {
+            auto found = task_index.find(r.job + " " + r.instance + " " + std::to_string(r.work));
+            if (found == task_index.end() || r.run >= tasks[found->second].params.runs)
+                return {};
+            return found->second;
+        };
+        size_t stale = 0;
+        for (const auto& r : journal.results())
+            stale += !journaled_task(r);
+        if (stale > 0)
+            BLT_INFO("%d runs in %s are of other settings, run counts or solver versions and are not used", stale,
+                     options.journal_path.c_str());
+
+        // one unit per run, the tasks are already longest first so handing the units out in order keeps the long runs at the front
+        std::vector<work_unit> units;
+        size_t skipped = 0;
+        size_t cached = 0;
+        for (size_t t = 0; t < tasks.size(); t++)
+        {
+            const auto& task = tasks[t];
+            std::vector<record> records;
+            // a run stopped by the clock depends on the machine, it is never cached
+            if (cache.enabled() && task.params.seed && task.params.termination.time_budget == 0)
+                records = load_problem(task.problem);
+            for (size_t j = 0; j < task.params.runs; j++)
+            {
+                if (journal.contains(task.job, task.instance, works[t], j))
+                {
+                    skipped++;
+                    continue;
+                }
+                work_unit unit{t, j, {}};
+                if (!records.empty())
+                {
+                    unit.key = run_key(records, task.params, *task.params.seed + j);
+                    run_result result;
+                    if (cache.lookup(*unit.key, result))
+                    {
+                        result.job = task.job;
+                        result.instance = task.instance;
+                        result.run = j;
+                        result.work = works[t];
+                        measure_targets(result, known, options.target_gap);
+                        journal.append(result);
+                        cached++;
+                        continue;
+                    }
+                }
+                units.push_back(unit);
+            }
+        }
+        BLT_INFO("%d tasks, %d runs to do, %d already in %s, %d taken from the cache", tasks.size(), units.size(), skipped,
+                 options.journal_path.c_str(), cached);
+
+        // tasks whose means are already known well enough stop handing out runs, guarded by the stats lock
+        std::mutex stats_lock;
+        std::vector<task_stats> live_stats(tasks.size());
+        std::vector<char> settled(tasks.size(), 0);
+        size_t settled_runs = 0;
+        if (options.ci_target > 0)
+        {
+            for (const auto& r : journal.results())
+            {
+                if (auto t = journaled_task(r))
+                    live_stats[*t].add(r);
+            }
+            for (size_t t = 0; t < tasks.size(); t++)
+                settled[t] = live_stats[t].settled(options);
+        }
+        // without pinning there is one node holding every unit and the workers are wherever the scheduler puts them
+        const auto topology = options.pin_threads ? numa_topology() : std::vector<numa_node>{};
+        const size_t nodes = std::max<size_t>(topology.size(), 1);
+
+        struct worker_placement
+        {
+            size_t node = 0;
+            std::int32_t cpu = -1;
+            bool pinned = false;
+            size_t local_runs = 0;
+            size_t stolen_runs = 0;
+            // every CPU the worker was seen on at the start of a run
+            std::vector<std::int32_t> seen;
+        };
+
+        std::vector<worker_placement> placements;
+        for (size_t n = 0; n < topology.size(); n++)
+        {
+            for (auto cpu : topology[n].cpus)
+                placements.push_back({n, cpu, false, 0, 0, {}});
+        }
+        const auto processor_count = options.pin_threads ? placements.size() : std::thread::hardware_concurrency();
+        placements.resize(processor_count);
+
+        // a task's runs all go to one node, spread over the nodes in the longest first order
+        std::vector<std::vector<size_t>> node_units(nodes);
+        for (size_t u = 0; u < units.size(); u++)
+            node_units[units[u].task % nodes].push_back(u);
+        std::vector<std::atomic<size_t>> node_next(nodes);
+        // each node's copy of an instance is built by one of its pinned workers, so first touch puts it in that node's memory
+        std::vector<std::unordered_map<size_t, std::shared_ptr<const ga::problem_instance>>> node_instances(nodes);
+        std::vector<std::mutex> node_instance_locks(nodes);
+        auto local_instance = [&](size_t node, size_t t) -> std::shared_ptr<const ga::problem_instance> {
+            if (!options.pin_threads)
+                return nullptr;
+            std::scoped_lock l(node_instance_locks[node]);
+            auto& instance = node_instances[node][t];
+            if (!instance)
+                instance = std::make_shared<const ga::problem_instance>(tasks[t].params.capacity, load_problem(tasks[t].problem));
+            return instance;
+        };
+
+        // each thread only ever touches its own profile
+        std::vector<ga::phase_profile> thread_profiles(processor_count);
+        std::barrier sync(processor_count + 1);
+
+        if (options.checkpoint_every > 0)
+            std::filesystem::create_directories(options.checkpoint_dir);
+
+        std::vector<std::jthread*> threads;
+        for (size_t i = 0; i < processor_count; i++)
+        {
+            threads.push_back(new std::jthread([&, i]() -> void {
+                auto& placement = placements[i];
+                if (options.pin_threads)
+                {
+                    placement.pinned = pin_current_thread(placement.cpu);
+                    if (!placement.pinned)
+                        BLT_WARN("Could not pin thread %d to CPU %d", i, placement.cpu);
+                }
+                BLT_INFO("Starting thread %d", i);
+                ga::trace::set_thread_name("batch worker " + std::to_string(i));
+                while (true)
+                {
+                    // this node's units first, then whatever the other nodes have left
+                    size_t unit = units.size();
+                    size_t from = placement.node;
+                    for (size_t k = 0; k < nodes && unit == units.size(); k++)
+                    {
+                        from = (placement.node + k) % nodes;
+                        auto next = node_next[from].fetch_add(1, std::memory_order_relaxed);
+                        if (next < node_units[from].size())
+                            unit = node_units[from][next];
+                    }
+                    if (unit >= units.size())
+                        break;
+                    const auto& task = tasks[units[unit].task];
+                    const auto j = units[unit].run;
+                    {
+                        std::scoped_lock l(stats_lock);
+                        if (settled[units[unit].task])
+                        {
+                            settled_runs++;
+                            continue;
+                        }
+                    }
+
+                    BLT_TRACE("%d Executing %s run %d", i, task.label.c_str(), j);
+                    if (from == placement.node)
+                        placement.local_runs++;
+                    else
+                        placement.stolen_runs++;
+                    const auto cpu = current_cpu();
+                    if (std::find(placement.seen.begin(), placement.seen.end(), cpu) == placement.seen.end())
+                        placement.seen.push_back(cpu);
+                    auto result = execute_run(options, task, j, local_instance(placement.node, units[unit].task));
+                    thread_profiles[i].merge(result.profile);
+                    if (units[unit].key)
+                        cache.store(*units[unit].key, result);
+                    measure_targets(result, known, options.target_gap);
+                    journal.append(result);
+                    if (options.ci_target > 0)
+                    {
+                        std::scoped_lock l(stats_lock);
+                        auto& stats = live_stats[units[unit].task];
+                        stats.add(result);
+                        if (!settled[units[unit].task] && stats.settled(options))
+                        {
+                            settled[units[unit].task] = 1;
+                            BLT_INFO("%s settled after %d runs, 95%% CI within %f%% of the mean", task.label.c_str(), stats.count(),
+                                     stats.widest_ci() * 100);
+                        }
+                    }
+                    if (options.checkpoint_every > 0)
+                    {
+                        std::error_code error;
+                        std::filesystem::remove(options.checkpoint_dir + "/" + run_name(task, j) + ".ckpt", error);
+                        std::filesystem::remove(options.checkpoint_dir + "/" + run_name(task, j) + "_wsum.ckpt", error);
+                    }
+                    BLT_TRACE("%d Ending %s run %d", i, task.label.c_str(), j);
+                    BLT_WARN(std::to_string(result.best_fitness.routes) + " " + std::to_string(result.best_fitness.distance));
+                    BLT_WARN(std::to_string(result.best_cars.routes) + " " + std::to_string(result.best_cars.distance));
+                    BLT_WARN(std::to_string(result.best_distance.routes) + " " + std::to_string(result.best_distance.distance));
+                }
+
+                BLT_INFO("Ending thread %d", i);
+                sync.arrive_and_wait();
+            }));
+        }
+        sync.arrive_and_wait();
+        for (auto* v : threads)
+            delete v;
+
+        BLT_TRACE("Threads deleted.");
+        ga::trace::flush();
+        if (settled_runs > 0)
+            BLT_INFO("Skipped %d runs of instances whose results had settled", settled_runs);
+
+        // the tables are rebuilt from the journal so runs finished before a restart count the same as the ones done now
+        std::vector<std::vector<run_result>> by_task(tasks.size());
+        for (auto& r : journal.results())
+        {
+            if (auto t = journaled_task(r))
+                by_task[*t].push_back(std::move(r));
+        }
+
+        size_t max_runs = 0;
+        for (const auto& t : tasks)
+            max_runs = std::max(max_runs, t.params.runs);
+        const auto runs = std::to_string(max_runs);
+
+        blt::string::TableFormatter formatter_average{"Average Of " + runs};
+        formatter_average.addColumn({"Instance"});
+        formatter_average.addColumn({"wGA"});
+        formatter_average.addColumn({"pGA Vehicles"});
+        formatter_average.addColumn({"pGA Distance"});
+        formatter_average.addColumn({"pGA Hypervolume"});
+
+        blt::string::TableFormatter formatter_best{"Best Of " + runs};
+        formatter_best.addColumn({"Instance"});
+        formatter_best.addColumn({"wGA"});
+        formatter_best.addColumn({"pGA Vehicles"});
+        formatter_best.addColumn({"pGA Distance"});
+        formatter_best.addColumn({"pGA Hypervolume"});
+
+        blt::string::TableFormatter formatter_spread{"Spread Of Runs (Standard Deviation)"};
+        formatter_spread.addColumn({"Instance"});
+        formatter_spread.addColumn({"Runs"});
+        formatter_spread.addColumn({"wGA"});
+        formatter_spread.addColumn({"pGA Vehicles"});
+        formatter_spread.addColumn({"pGA Distance"});
+        formatter_spread.addColumn({"pGA Hypervolume"});
+        formatter_spread.addColumn({"Widest CI95 (%)"});
+
+        blt::string::TableFormatter formatter_counters{"Operation Counts (Average Per Run Of " + runs + ")"};
+        formatter_counters.addColumn({"Instance"});
+        formatter_counters.addColumn({"Decodes"});
+        formatter_counters.addColumn({"Validations"});
+        formatter_counters.addColumn({"Rejected Cap/Arr/Ret"});
+        formatter_counters.addColumn({"Insertions Tried"});
+        formatter_counters.addColumn({"Mutation Retries"});
+        formatter_counters.addColumn({"Dominance Checks"});
+        formatter_counters.addColumn({"Evals/s"});
+
+        blt::string::TableFormatter formatter_termination{"Termination Of The pGA Runs"};
+        formatter_termination.addColumn({"Instance"});
+        formatter_termination.addColumn({"Generations Avg"});
+        formatter_termination.addColumn({"Min"});
+        formatter_termination.addColumn({"Max"});
+        formatter_termination.addColumn({"Stopped By"});
+
+        blt::string::TableFormatter formatter_target{"Time To Target (Seconds Of Stepping, Average Over The Runs That Got There)"};
+        formatter_target.addColumn({"Instance"});
+        formatter_target.addColumn({std::to_string(static_cast<int>(HYPERVOLUME_TARGET * 100)) + "% Final Hypervolume"});
+        formatter_target.addColumn({"Evaluations"});
+        formatter_target.addColumn({"Best Known +" + std::to_string(static_cast<int>(options.target_gap * 100)) + "% Reached"});
+        formatter_target.addColumn({"Seconds"});
+
+        std::vector<std::pair<std::string, ga::phase_profile>> instance_profiles;
+        ga::phase_profile total_profile;
+        std::ofstream sout("results_stats.csv");
+        running_stats::writeCSVHeader(sout);
+        for (size_t t = 0; t < tasks.size(); t++)
+        {
+            const auto& task = tasks[t];
+            const auto& results = by_task[t];
+            if (results.empty())
+                continue;
+
+            ga::individual_point bestCars = ga::individual_point::max();
+            ga::individual_point bestDistance = ga::individual_point::max();
+            ga::individual_point bestFitness = ga::individual_point::max();
+
+            task_stats stats;
+
+            ga::phase_profile instance_profile;
+            ga::op_counters instance_counters;
+            std::uint64_t instance_evaluations = 0;
+            double instance_seconds = 0;
+            running_stats generations;
+            running_stats hypervolume_seconds;
+            running_stats hypervolume_evaluations;
+            running_stats known_seconds;
+            std::array<size_t, static_cast<size_t>(stop_reason::EVALUATIONS) + 1> stopped_by{};
+            for (const auto& r : results)
+            {
+                instance_profile.merge(r.profile);
+                generations.add(static_cast<double>(r.generations));
+                stopped_by[static_cast<size_t>(r.stopped)]++;
+                if (!std::isnan(r.hypervolume_target_seconds))
+                {
+                    hypervolume_seconds.add(r.hypervolume_target_seconds);
+                    hypervolume_evaluations.add(static_cast<double>(r.hypervolume_target_evaluations));
+                }
+                if (!std::isnan(r.known_target_seconds))
+                    known_seconds.add(r.known_target_seconds);
+                instance_counters += r.counters;
+                instance_evaluations += r.evaluations;
+                instance_seconds += r.seconds;
+
+                stats.add(r);
+
+                if (r.best_cars.routes < bestCars.routes)
+                    bestCars = r.best_cars;
+                if (r.best_distance.distance < bestDistance.distance)
+                    bestDistance = r.best_distance;
+                if (r.best_fitness.fitness < bestFitness.fitness)
+                    bestFitness = r.best_fitness;
+            }
+            total_profile.merge(instance_profile);
+            instance_profiles.emplace_back(task.label, instance_profile);
+            for (size_t o = 0; o < stats.objectives.size(); o++)
+                stats.objectives[o].writeCSV(sout, task.label, task_stats::NAMES[o]);
+
+            const auto& o = stats.objectives;
+            formatter_average.addRow({task.label,
+                                      std::to_string(o[0].mean()) + " " + std::to_string(o[1].mean()),
+                                      std::to_string(o[2].mean()) + " " + std::to_string(o[3].mean()),
+                                      std::to_string(o[4].mean()) + " " + std::to_string(o[5].mean()),
+                                      o[6].count() > 0 ? std::to_string(o[6].mean()) : "-"});
+
+            formatter_spread.addRow({task.label,
+                                     std::to_string(stats.count()),
+                                     std::to_string(o[0].stddev()) + " " + std::to_string(o[1].stddev()),
+                                     std::to_string(o[2].stddev()) + " " + std::to_string(o[3].stddev()),
+                                     std::to_string(o[4].stddev()) + " " + std::to_string(o[5].stddev()),
+                                     o[6].count() > 0 ? std::to_string(o[6].stddev()) : "-",
+                                     stats.count() < 2 ? "-" : std::to_string(stats.widest_ci() * 100)});
+
+            formatter_best.addRow({task.label,
+                                   std::to_string(bestFitness.routes) + " " + std::to_string(bestFitness.distance),
+                                   std::to_string(bestCars.routes) + " " + std::to_string(bestCars.distance),
+                                   std::to_string(bestDistance.routes) + " " + std::to_string(bestDistance.distance),
+                                   o[6].count() > 0 ? std::to_string(o[6].max()) : "-"});
+
+            std::string stopped_str;
+            for (size_t s = 0; s < stopped_by.size(); s++)
+            {
+                if (stopped_by[s] == 0)
+                    continue;
+                if (!stopped_str.empty())
+                    stopped_str += ", ";
+                stopped_str += std::string(to_string(static_cast<stop_reason>(s))) + " " + std::to_string(stopped_by[s]);
+            }
+            if (generations.count() > 0)
+                formatter_termination.addRow({task.label, std::to_string(generations.mean()), std::to_string(generations.min()),
+                                              std::to_string(generations.max()), stopped_str});
+            else
+                formatter_termination.addRow({task.label, "-", "-", "-", "-"});
+
+            formatter_target.addRow({task.label,
+                                     hypervolume_seconds.count() > 0 ? std::to_string(hypervolume_seconds.mean()) : "-",
+                                     hypervolume_evaluations.count() > 0 ? std::to_string(hypervolume_evaluations.mean()) : "-",
+                                     std::to_string(known_seconds.count()) + "/" + std::to_string(results.size()),
+                                     known_seconds.count() > 0 ? std::to_string(known_seconds.mean()) : "-"});
+
+            auto per_run = [&](ga::counter c) {
+                return std::to_string(instance_counters[c] / results.size());
+            };
+            formatter_counters.addRow({task.label,
+                                       per_run(ga::counter::DECODES),
+                                       per_run(ga::counter::VALIDATIONS),
+                                       per_run(ga::counter::REJECT_CAPACITY) + "/" + per_run(ga::counter::REJECT_ARRIVAL) + "/" +
+                                       per_run(ga::counter::REJECT_RETURN),
+                                       per_run(ga::counter::INSERTIONS_TRIED),
+                                       per_run(ga::counter::MUTATION_RETRIES),
+                                       per_run(ga::counter::DOMINANCE_CHECKS),
+                                       instance_seconds > 0 ? std::to_string(static_cast<double>(instance_evaluations) / instance_seconds)
+                                                            : "-"});
+        }
+
+        std::ofstream lout("results.txt");
+        for (const auto& v : formatter_average.createTable(true, true))
+        {
+            std::cout << v << "\n";
+            lout << v << "\n";
+        }
+        for (const auto& v : formatter_best.createTable(true, true))
+        {
+            std::cout << v << "\n";
+            lout << v << "\n";
+        }
+
+        for (const auto& v : formatter_spread.createTable(true, true))
+        {
+            std::cout << v << "\n";
+            lout << v << "\n";
+        }
+
+        for (const auto& v : formatter_termination.createTable(true, true))
+        {
+            std::cout << v << "\n";
+            lout << v << "\n";
+        }
+
+        for (const auto& v : formatter_target.createTable(true, true))
+        {
+            std::cout << v << "\n";
+            lout << v << "\n";
+        }
+
+        // only the runs done in this session have a worker
+        blt::string::TableFormatter formatter_placement{options.pin_threads ? "Worker Placement (" + std::to_string(nodes) + " NUMA Nodes)"
+                                                                            : std::string("Worker Placement (Not Pinned)")};
+        formatter_placement.addColumn({"Thread"});
+        formatter_placement.addColumn({"Node"});
+        formatter_placement.addColumn({"Pinned CPU"});
+        formatter_placement.addColumn({"CPUs Seen"});
+        formatter_placement.addColumn({"Local Runs"});
+        formatter_placement.addColumn({"Stolen Runs"});
+        for (size_t i = 0; i < placements.size(); i++)
+        {
+            auto& placement = placements[i];
+            std::sort(placement.seen.begin(), placement.seen.end());
+            std::string seen;
+            for (auto cpu : placement.seen)
+                seen += (seen.empty() ? "" : ",") + std::to_string(cpu);
+            formatter_placement.addRow({std::to_string(i), options.pin_threads ? std::to_string(topology[placement.node].id) : "-",
+                                        placement.pinned ? std::to_string(placement.cpu) : "-", seen.empty() ? "-" : seen,
+                                        std::to_string(placement.local_runs), std::to_string(placement.stolen_runs)});
+        }
+        for (const auto& v : formatter_placement.createTable(true, true))
+        {
+            std::cout << v << "\n";
+            lout << v << "\n";
+        }
+
+        if constexpr (ga::COUNTERS_ENABLED)
+        {
+            for (const auto& v : formatter_counters.createTable(true, true))
+            {
+                std::cout << v << "\n";
+                lout << v << "\n";
+            }
+        }
+
+        for (const auto& v : total_profile.createTable("Step Profile Of All Runs"))
+        {
+            std::cout << v << "\n";
+            lout << v << "\n";
+        }
+
+        std::ofstream pout("profile.csv");
+        ga::phase_profile::writeCSVHeader(pout);
+        for (const auto& v : instance_profiles)
+            v.second.writeCSV(pout, v.first);
+        // only the runs done in this session have a thread
+        for (size_t i = 0; i < thread_profiles.size(); i++)
+            thread_profiles[i].writeCSV(pout, "thread " + std::to_string(i));
+        total_profile.writeCSV(pout, "total");
+    }
+
+}
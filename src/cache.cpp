@@ -0,0 +1,140 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <cache.h>
+#include <binary_io.h>
+#include <hash.h>
+#include <blt/std/logging.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace ga
+{
+    static constexpr char CACHE_MAGIC[4] = {'V', 'R', 'P', 'R'};
+    static constexpr std::uint32_t CACHE_VERSION = 5;
+
+    template<typename T>
+    static std::uint64_t hash_value(const T& value, std::uint64_t hash)
+    {
+        return fnv1a(&value, sizeof(T), hash);
+    }
+
+    std::uint64_t run_key(const std::vector<record>& records, const batch_params& params, std::uint64_t seed)
+    {
+        auto hash = fnv1a(SOLVER_VERSION);
+        // field by field, the padding inside a record is not part of the problem
+        for (const auto& r : records)
+        {
+            hash = hash_value(r.customer_number, hash);
+            for (double v : {r.x, r.y, r.demand, r.ready, r.due, r.service_time})
+                hash = hash_value(v, hash);
+        }
+        hash = hash_value(params.capacity, hash);
+        hash = hash_value(params.objective, hash);
+        hash = hash_value(params.pareto_objectives.size(), hash);
+        for (auto id : params.pareto_objectives)
+            hash = hash_value(id, hash);
+        hash = hash_value(params.paired, hash);
+        hash = hash_value(params.stepping, hash);
+        hash = hash_value(params.immigrants, hash);
+        hash = hash_value(params.termination.generations, hash);
+        hash = hash_value(params.termination.stagnation, hash);
+        hash = hash_value(params.termination.evaluation_budget, hash);
+        hash = hash_value(params.population, hash);
+        hash = hash_value(params.generations, hash);
+        hash = hash_value(params.tournament, hash);
+        hash = hash_value(params.elite, hash);
+        hash = hash_value(params.crossover, hash);
+        hash = hash_value(params.mutation, hash);
+        hash = hash_value(params.mutation2, hash);
+        return hash_value(seed, hash);
+    }
+
+    result_cache::result_cache(std::string directory): dir(std::move(directory))
+    {
+        if (!enabled())
+            return;
+        std::error_code error;
+        std::filesystem::create_directories(dir, error);
+        if (error)
+        {
+            BLT_WARN("Unable to create result cache %s, caching is off: %s", dir.c_str(), error.message().c_str());
+            dir.clear();
+        }
+    }
+
+    std::string result_cache::path(std::uint64_t key) const
+    {
+        std::ostringstream name;
+        name << dir << '/' << std::hex << key << ".run";
+        return name.str();
+    }
+
+    bool result_cache::lookup(std::uint64_t key, run_result& result) const
+    {
+        if (!enabled())
+            return false;
+        std::ifstream in(path(key), std::ios::binary);
+        if (!in.is_open())
+            return false;
+        char magic[4];
+        std::uint32_t version = 0;
+        std::uint64_t stored_key = 0;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || !binary::read(in, version) ||
+            version != CACHE_VERSION || !binary::read(in, stored_key) || stored_key != key)
+            return false;
+        try
+        {
+            return binary::read(in, result.capacity) && binary::read(in, result.seconds) && binary::read(in, result.best_cars) &&
+                   binary::read(in, result.best_distance) && binary::read(in, result.best_fitness) && binary::read(in, result.counters) &&
+                   binary::read(in, result.profile) && binary::read_vector(in, result.front) && binary::read(in, result.hypervolume) &&
+                   binary::read(in, result.generations) && binary::read(in, result.stopped) && binary::read(in, result.evaluations) &&
+                   binary::read_vector(in, result.anytime);
+        } catch (const std::runtime_error& e)
+        {
+            // a damaged entry is a miss, the run is done again and overwrites it
+            BLT_WARN("Ignoring damaged cache entry %s: %s", path(key).c_str(), e.what());
+            return false;
+        }
+    }
+
+    void result_cache::store(std::uint64_t key, const run_result& result) const
+    {
+        if (!enabled())
+            return;
+        const auto file = path(key);
+        const auto temp = file + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+            binary::write(out, CACHE_VERSION);
+            binary::write(out, key);
+            binary::write(out, result.capacity);
+            binary::write(out, result.seconds);
+            binary::write(out, result.best_cars);
+            binary::write(out, result.best_distance);
+            binary::write(out, result.best_fitness);
+            binary::write(out, result.counters);
+            binary::write(out, result.profile);
+            binary::write_vector(out, result.front);
+            binary::write(out, result.hypervolume);
+            binary::write(out, result.generations);
+            binary::write(out, result.stopped);
+            binary::write(out, result.evaluations);
+            binary::write_vector(out, result.anytime);
+            if (!out)
+            {
+                BLT_WARN("Unable to write cache entry %s", temp.c_str());
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temp, file, error);
+        if (error)
+            BLT_WARN("Unable to move cache entry into place at %s: %s", file.c_str(), error.message().c_str());
+    }
+
+}
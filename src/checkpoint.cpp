@@ -0,0 +1,308 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <program.h>
+#include <binary_io.h>
+#include <blt/std/logging.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+/**
+ * Checkpoint file layout (native endian):
+ *  "VRPC" | u32 version
+ *  parameters: i32 population | i32 generations | i32 tournament | i32 elite | f64 crossover | f64 mutation | f64 mutation2 | u64 seed
+ *              | u8 objective mode | u8 pareto objective ids[]
+ *  problem:    i32 capacity | records[]
+ *  state:      u64 generation count | string rng state | population | history | best trackers | last front | best/avg history
+ *              | f64 hypervolume history[] | profile | counters
+ *  termination: f64 archive vehicles, distance pairs[] | u64 last improvement | u64 generations | u64 stagnation | f64 time budget
+ *              | u64 evaluation budget | anytime points[]
+ *  stepping:   u8 clone immigrants | u8 step mode | u64 wall clock stepping ns | previous population | u64 clone count
+ *              | u64 immigrant count | u8 population evaluated (a resumed steady state run ranks it without decoding it again)
+ *  stream:     string path (empty if not streaming) | u64 generations per block | u64 file offset
+ * A population is u64 size | individuals, each with its u64 gene hash.
+ */
+namespace ga
+{
+    static constexpr char CHECKPOINT_MAGIC[4] = {'V', 'R', 'P', 'C'};
+    static constexpr std::uint32_t CHECKPOINT_VERSION = 1;
+
+    struct program::checkpoint_state
+    {
+        std::int32_t population_size = 0;
+        std::int32_t generation_count = 0;
+        std::int32_t tournament_size = 0;
+        std::int32_t elite_count = 0;
+        double crossover_rate = 0;
+        double mutation_rate = 0;
+        double mutation2_rate = 0;
+        std::uint64_t seed = 0;
+        std::uint8_t objective = 0;
+        std::vector<objective_id> pareto_objectives;
+
+        std::int32_t capacity = 0;
+        std::vector<record> records;
+
+        std::uint64_t count = 0;
+        std::string rng;
+        population pop;
+        history_store history;
+        individual_point best_distance, best_cars, best_fitness;
+        std::vector<individual_point> last_front;
+        std::vector<avg_point> best_history;
+        std::vector<avg_point> avg_history;
+        std::vector<double> hypervolume_history;
+        phase_profile profile;
+        op_counters counters;
+
+        // flattened, a pair is not trivially copyable
+        std::vector<double> archive;
+        std::uint64_t last_improvement = 0;
+        termination_criteria termination;
+        std::vector<anytime_point> anytime_trace;
+        std::uint8_t clone_immigrants = 0;
+        std::uint8_t stepping = 0;
+        std::uint64_t stepping_ns = 0;
+        population previous;
+        std::uint64_t clone_count = 0;
+        std::uint64_t immigrant_count = 0;
+        std::uint8_t evaluated = 0;
+
+        std::string stream_path;
+        std::uint64_t stream_block = 0;
+        std::uint64_t stream_offset = 0;
+    };
+
+    void write_individual(std::ostream& out, const individual& i)
+    {
+        binary::write(out, i.c);
+        binary::write(out, static_cast<std::uint64_t>(i.routes.size()));
+        for (const auto& r : i.routes)
+        {
+            binary::write_vector(out, r.customers);
+            binary::write(out, r.total_distance);
+        }
+        binary::write(out, i.total_routes_distance);
+        binary::write(out, i.rank);
+        binary::write(out, i.fitness);
+        binary::write(out, i.hash);
+    }
+
+    bool read_individual(std::istream& in, individual& i)
+    {
+        std::uint64_t routes = 0;
+        if (!binary::read(in, i.c) || !binary::read(in, routes) || routes > CUSTOMER_COUNT)
+            return false;
+        i.routes.resize(routes);
+        for (auto& r : i.routes)
+        {
+            if (!binary::read_vector(in, r.customers, CUSTOMER_COUNT) || !binary::read(in, r.total_distance))
+                return false;
+        }
+        return binary::read(in, i.total_routes_distance) && binary::read(in, i.rank) && binary::read(in, i.fitness) &&
+               binary::read(in, i.hash);
+    }
+
+    static void write_population(std::ostream& out, const population& pop)
+    {
+        binary::write(out, static_cast<std::uint64_t>(pop.pops.size()));
+        for (const auto& i : pop.pops)
+            write_individual(out, i);
+    }
+
+    static bool read_population(std::istream& in, population& pop, std::uint64_t limit)
+    {
+        std::uint64_t size = 0;
+        if (!binary::read(in, size))
+            return false;
+        // every individual starts with its chromosome
+        binary::check_length<chromosome>(in, size, limit);
+        pop.pops.resize(size);
+        return std::all_of(pop.pops.begin(), pop.pops.end(), [&in](individual& i) { return read_individual(in, i); });
+    }
+
+    static bool read_objectives(std::istream& in, std::vector<objective_id>& ids)
+    {
+        if (!binary::read_vector(in, ids, MAX_OBJECTIVES) || ids.size() < 2)
+            return false;
+        return std::all_of(ids.begin(), ids.end(), [](objective_id id) { return id <= objective_id::IMBALANCE; });
+    }
+    
+    bool program::checkpoint(const std::string& path)
+    {
+        // the stream has to be on disk up to this generation before its offset means anything
+        std::uint64_t stream_offset = history_stream ? history_stream->sync() : 0;
+
+        auto temp_path = path + ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+            {
+                BLT_ERROR("Unable to open checkpoint file %s", temp_path.c_str());
+                return false;
+            }
+            out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+            binary::write(out, CHECKPOINT_VERSION);
+
+            binary::write(out, POPULATION_SIZE);
+            binary::write(out, GENERATION_COUNT);
+            binary::write(out, TOURNAMENT_SIZE);
+            binary::write(out, ELITE_COUNT);
+            binary::write(out, CROSSOVER_RATE);
+            binary::write(out, MUTATION_RATE);
+            binary::write(out, MUTATION2_RATE);
+            binary::write(out, SEED);
+            binary::write(out, static_cast<std::uint8_t>(objective));
+            binary::write_vector(out, pareto_objectives);
+
+            binary::write(out, capacity);
+            binary::write_vector(out, records);
+
+            binary::write(out, static_cast<std::uint64_t>(count));
+            binary::write_string(out, engine.state());
+            write_population(out, current_population);
+            generation_data.save(out);
+            binary::write(out, best_distance);
+            binary::write(out, best_cars);
+            binary::write(out, best_fitness);
+            binary::write_vector(out, last_front);
+            binary::write_vector(out, best_history);
+            binary::write_vector(out, avg_history);
+            binary::write_vector(out, hypervolume_history);
+            binary::write(out, profile);
+            binary::write(out, counters);
+
+            std::vector<double> archive_values;
+            for (const auto& [vehicles, distance] : archive.points())
+            {
+                archive_values.push_back(vehicles);
+                archive_values.push_back(distance);
+            }
+            binary::write_vector(out, archive_values);
+            binary::write(out, static_cast<std::uint64_t>(last_improvement));
+            binary::write(out, termination.generations);
+            binary::write(out, termination.stagnation);
+            binary::write(out, termination.time_budget);
+            binary::write(out, termination.evaluation_budget);
+            binary::write_vector(out, anytime_trace);
+            binary::write(out, static_cast<std::uint8_t>(clone_immigrants));
+            binary::write(out, static_cast<std::uint8_t>(stepping));
+            binary::write(out, stepping_ns);
+            write_population(out, previous_population);
+            binary::write(out, clone_count);
+            binary::write(out, immigrant_count);
+            binary::write(out, static_cast<std::uint8_t>(population_evaluated));
+
+            binary::write_string(out, history_stream ? history_stream->path() : std::string{});
+            binary::write(out, static_cast<std::uint64_t>(history_stream ? history_stream->generations_per_block() : 0));
+            binary::write(out, stream_offset);
+
+            out.flush();
+            if (!out)
+            {
+                BLT_ERROR("Failed writing checkpoint file %s", temp_path.c_str());
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temp_path, path, error);
+        if (error)
+        {
+            BLT_ERROR("Unable to move checkpoint into place at %s: %s", path.c_str(), error.message().c_str());
+            return false;
+        }
+        return true;
+    }
+
+    program::checkpoint_state program::read_checkpoint(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        char magic[4];
+        std::uint32_t version = 0;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || !binary::read(in, version) ||
+            version != CHECKPOINT_VERSION)
+            throw std::runtime_error(path + " is not a version " + std::to_string(CHECKPOINT_VERSION) + " checkpoint");
+
+        checkpoint_state state;
+        std::uint64_t population_size = 0;
+        bool ok = false;
+        // every length in the file is checked against what is left of it and its own limit before anything is sized from it
+        try
+        {
+            ok = binary::read(in, state.population_size) && binary::read(in, state.generation_count) &&
+                 binary::read(in, state.tournament_size) && binary::read(in, state.elite_count) && binary::read(in, state.crossover_rate) &&
+                 binary::read(in, state.mutation_rate) && binary::read(in, state.mutation2_rate) && binary::read(in, state.seed) &&
+                 binary::read(in, state.objective) && read_objectives(in, state.pareto_objectives) &&
+                 binary::read(in, state.capacity) && binary::read_vector(in, state.records, CUSTOMER_COUNT + 1) &&
+                 binary::read(in, state.count) && binary::read_string(in, state.rng) && state.population_size > 0 &&
+                 state.objective <= static_cast<std::uint8_t>(objective_mode::LEXICOGRAPHIC);
+            population_size = static_cast<std::uint64_t>(std::max(state.population_size, 0));
+            ok = ok && read_population(in, state.pop, population_size) && state.pop.pops.size() == population_size &&
+                 state.history.load(in) && binary::read(in, state.best_distance) && binary::read(in, state.best_cars) &&
+                 binary::read(in, state.best_fitness) && binary::read_vector(in, state.last_front, population_size) &&
+                 binary::read_vector(in, state.best_history) && binary::read_vector(in, state.avg_history) &&
+                 binary::read_vector(in, state.hypervolume_history) && binary::read(in, state.profile) && binary::read(in, state.counters) &&
+                 binary::read_vector(in, state.archive) && binary::read(in, state.last_improvement) &&
+                 binary::read(in, state.termination.generations) && binary::read(in, state.termination.stagnation) &&
+                 binary::read(in, state.termination.time_budget) && binary::read(in, state.termination.evaluation_budget) &&
+                 binary::read_vector(in, state.anytime_trace) && binary::read(in, state.clone_immigrants) &&
+                 binary::read(in, state.stepping) && binary::read(in, state.stepping_ns) &&
+                 read_population(in, state.previous, population_size) && binary::read(in, state.clone_count) &&
+                 binary::read(in, state.immigrant_count) && binary::read(in, state.evaluated) && binary::read_string(in, state.stream_path) &&
+                 binary::read(in, state.stream_block) && binary::read(in, state.stream_offset);
+        } catch (const std::runtime_error& e)
+        {
+            throw std::runtime_error("Checkpoint " + path + " is corrupt: " + e.what());
+        }
+        if (!ok)
+            throw std::runtime_error("Checkpoint " + path + " is truncated or corrupt");
+        return state;
+    }
+
+    program::program(const std::string& checkpoint_path): program(read_checkpoint(checkpoint_path))
+    {}
+
+    program::program(checkpoint_state&& state):
+            instance(std::make_shared<const problem_instance>(state.capacity, std::move(state.records))), capacity(instance->capacity),
+            records(instance->records), POPULATION_SIZE(state.population_size),
+            GENERATION_COUNT(state.generation_count), TOURNAMENT_SIZE(state.tournament_size), ELITE_COUNT(state.elite_count),
+            CROSSOVER_RATE(state.crossover_rate), MUTATION_RATE(state.mutation_rate), MUTATION2_RATE(state.mutation2_rate), SEED(state.seed),
+            objective(static_cast<objective_mode>(state.objective)), pareto_objectives(std::move(state.pareto_objectives))
+    {
+        count = state.count;
+        if (!engine.restore(state.rng))
+            throw std::runtime_error("Checkpoint has an unreadable random engine state");
+        current_population = std::move(state.pop);
+        generation_data = std::move(state.history);
+        best_distance = state.best_distance;
+        best_cars = state.best_cars;
+        best_fitness = state.best_fitness;
+        last_front = std::move(state.last_front);
+        best_history = std::move(state.best_history);
+        avg_history = std::move(state.avg_history);
+        hypervolume_history = std::move(state.hypervolume_history);
+        profile = state.profile;
+        counters = state.counters;
+        for (size_t i = 0; i + 1 < state.archive.size(); i += 2)
+            archive.insert(state.archive[i], state.archive[i + 1]);
+        last_improvement = state.last_improvement;
+        termination = state.termination;
+        anytime_trace = std::move(state.anytime_trace);
+        clone_immigrants = state.clone_immigrants != 0;
+        if (state.stepping > static_cast<std::uint8_t>(step_mode::STEADY_STATE))
+            throw std::runtime_error("Checkpoint has an unknown step mode");
+        stepping = static_cast<step_mode>(state.stepping);
+        stepping_ns = state.stepping_ns;
+        previous_population = std::move(state.previous);
+        clone_count = state.clone_count;
+        immigrant_count = state.immigrant_count;
+        population_evaluated = state.evaluated != 0;
+        if (!state.stream_path.empty())
+            history_stream = std::make_unique<history_writer>(state.stream_path, POPULATION_SIZE, state.stream_block, state.stream_offset);
+    }
+
+}
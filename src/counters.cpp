@@ -0,0 +1,21 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <counters.h>
+
+namespace ga
+{
+
+    void op_counters::writeCSV(std::ostream& out, std::uint64_t generations, double seconds) const
+    {
+        out << "Counter,Value,PerGeneration,PerSecond\n";
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            auto v = static_cast<double>(values[i]);
+            out << COUNTER_NAMES[i] << ',' << values[i] << ',' << (generations == 0 ? 0 : v / static_cast<double>(generations)) << ','
+                << (seconds <= 0 ? 0 : v / seconds) << '\n';
+        }
+    }
+
+}
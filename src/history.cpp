@@ -0,0 +1,219 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <history.h>
+#include <binary_io.h>
+#include <blt/std/logging.h>
+#include <blt/std/string.h>
+#include <algorithm>
+#include <charconv>
+
+namespace ga
+{
+
+    static bool parse_interval(const std::string& str, size_t& interval)
+    {
+        const auto* end = str.data() + str.size();
+        auto [ptr, error] = std::from_chars(str.data(), end, interval);
+        return error == std::errc{} && ptr == end;
+    }
+    
+    history_config history_config::parse(const std::string& str)
+    {
+        auto args = blt::string::split(str, ':');
+        history_config config;
+        if (args.empty())
+            return config;
+        size_t interval = 0;
+        if ((args[0] == "every" || args[0] == "ring") && (args.size() < 2 || !parse_interval(args[1], interval)))
+            BLT_WARN("History policy '%s' needs a whole number, keeping the full history", str.c_str());
+        else if (args[0] == "every")
+            config = {history_policy::EVERY_K, interval};
+        else if (args[0] == "ring")
+            config = {history_policy::RING, interval};
+        else if (args[0] == "rank1")
+            config.policy = history_policy::RANK_ONE;
+        else if (args[0] != "full")
+            BLT_WARN("Unknown history policy '%s', keeping the full history", str.c_str());
+        if (config.interval == 0)
+            config.interval = 1;
+        return config;
+    }
+
+    std::string history_config::to_string() const
+    {
+        switch (policy)
+        {
+            case history_policy::EVERY_K:
+                return "every:" + std::to_string(interval);
+            case history_policy::RANK_ONE:
+                return "rank1";
+            case history_policy::RING:
+                return "ring:" + std::to_string(interval);
+            default:
+                return "full";
+        }
+    }
+
+    history_store::history_store(history_config config, size_t population_size): conf(config), stride(population_size)
+    {
+        if (conf.policy == history_policy::RING)
+        {
+            // the ring never grows, so all of it is allocated up front
+            distance.resize(conf.interval * stride);
+            fitness.resize(conf.interval * stride);
+            rank.resize(conf.interval * stride);
+            routes.resize(conf.interval * stride);
+            generations.resize(conf.interval);
+            offsets.resize(conf.interval);
+            counts.resize(conf.interval);
+        }
+    }
+
+    bool history_store::begin(size_t generation)
+    {
+        if (conf.policy == history_policy::EVERY_K && generation % conf.interval != 0)
+            return false;
+        if (conf.policy == history_policy::RING)
+        {
+            open_slot = recorded % conf.interval;
+            offsets[open_slot] = open_slot * stride;
+            counts[open_slot] = 0;
+            generations[open_slot] = generation;
+        } else
+        {
+            open_slot = generations.size();
+            generations.push_back(generation);
+            offsets.push_back(distance.size());
+            counts.push_back(0);
+        }
+        return true;
+    }
+
+    void history_store::push(const individual_point& p)
+    {
+        if (conf.policy == history_policy::RANK_ONE && p.rank != 1)
+            return;
+        auto& count = counts[open_slot];
+        if (conf.policy == history_policy::RING)
+        {
+            if (count >= stride)
+                return;
+            auto index = offsets[open_slot] + count;
+            distance[index] = p.distance;
+            fitness[index] = p.fitness;
+            rank[index] = p.rank;
+            routes[index] = static_cast<std::uint32_t>(p.routes);
+        } else
+        {
+            distance.push_back(p.distance);
+            fitness.push_back(p.fitness);
+            rank.push_back(p.rank);
+            routes.push_back(static_cast<std::uint32_t>(p.routes));
+        }
+        count++;
+    }
+
+    void history_store::end()
+    {
+        recorded++;
+    }
+
+    void history_store::clear()
+    {
+        *this = history_store(conf, stride);
+    }
+
+    size_t history_store::size() const
+    {
+        if (conf.policy == history_policy::RING)
+            return std::min(recorded, conf.interval);
+        return generations.size();
+    }
+
+    size_t history_store::slot(size_t i) const
+    {
+        if (conf.policy == history_policy::RING && recorded > conf.interval)
+            return (recorded + i) % conf.interval;
+        return i;
+    }
+
+    size_t history_store::generation(size_t i) const
+    {
+        return generations[slot(i)];
+    }
+
+    size_t history_store::points(size_t i) const
+    {
+        return counts[slot(i)];
+    }
+
+    individual_point history_store::point(size_t i, size_t j) const
+    {
+        auto index = offsets[slot(i)] + j;
+        return {distance[index], fitness[index], rank[index], routes[index]};
+    }
+
+    size_t history_store::memory() const
+    {
+        return distance.capacity() * sizeof(double) + fitness.capacity() * sizeof(fitness_t) + rank.capacity() * sizeof(rank_t) +
+               routes.capacity() * sizeof(std::uint32_t) + (generations.capacity() + offsets.capacity() + counts.capacity()) * sizeof(size_t);
+    }
+
+    void history_store::write_csv(std::ostream& out) const
+    {
+        out << "Generation,Distance,Fitness,Rank,Routes\n";
+        for (size_t i = 0; i < size(); i++)
+        {
+            for (size_t j = 0; j < points(i); j++)
+            {
+                auto p = point(i, j);
+                out << generation(i) + 1 << ',' << p.distance << ',' << p.fitness << ',' << p.rank << ',' << p.routes << '\n';
+            }
+        }
+    }
+
+    void history_store::save(std::ostream& out) const
+    {
+        binary::write(out, conf.policy);
+        binary::write(out, static_cast<std::uint64_t>(conf.interval));
+        binary::write(out, static_cast<std::uint64_t>(stride));
+        binary::write(out, static_cast<std::uint64_t>(recorded));
+        binary::write(out, static_cast<std::uint64_t>(open_slot));
+        binary::write_vector(out, distance);
+        binary::write_vector(out, fitness);
+        binary::write_vector(out, rank);
+        binary::write_vector(out, routes);
+        binary::write_vector(out, generations);
+        binary::write_vector(out, offsets);
+        binary::write_vector(out, counts);
+    }
+
+    bool history_store::load(std::istream& in)
+    {
+        std::uint64_t interval = 0, stride_ = 0, recorded_ = 0, open_slot_ = 0;
+        if (!binary::read(in, conf.policy) || !binary::read(in, interval) || !binary::read(in, stride_) || !binary::read(in, recorded_) ||
+            !binary::read(in, open_slot_) || conf.policy > history_policy::RING || interval == 0)
+            return false;
+        conf.interval = interval;
+        stride = stride_;
+        recorded = recorded_;
+        open_slot = open_slot_;
+        if (!binary::read_vector(in, distance) || !binary::read_vector(in, fitness) || !binary::read_vector(in, rank) ||
+            !binary::read_vector(in, routes) || !binary::read_vector(in, generations) || !binary::read_vector(in, offsets) ||
+            !binary::read_vector(in, counts))
+            return false;
+        // the columns have to line up and every recorded generation has to lie inside them
+        if (fitness.size() != distance.size() || rank.size() != distance.size() || routes.size() != distance.size() ||
+            offsets.size() != generations.size() || counts.size() != generations.size())
+            return false;
+        for (size_t i = 0; i < offsets.size(); i++)
+        {
+            if (offsets[i] > distance.size() || counts[i] > distance.size() - offsets[i])
+                return false;
+        }
+        return conf.policy != history_policy::RING || (generations.size() == conf.interval && open_slot < conf.interval);
+    }
+
+}
@@ -0,0 +1,212 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <history_file.h>
+#include <binary_io.h>
+#include <blt/std/logging.h>
+#include <cstring>
+#include <filesystem>
+
+namespace ga
+{
+    static constexpr char FILE_MAGIC[4] = {'V', 'R', 'P', 'H'};
+    static constexpr char BLOCK_MAGIC[4] = {'B', 'L', 'K', '0'};
+    // anything larger than this is a corrupt block header rather than a real block
+    static constexpr std::uint64_t MAX_BLOCK_POINTS = std::uint64_t{1} << 32;
+
+    void history_block::clear()
+    {
+        generations.clear();
+        counts.clear();
+        distance.clear();
+        fitness.clear();
+        rank.clear();
+        vehicles.clear();
+    }
+
+    history_writer::history_writer(const std::string& path, size_t population_size, size_t generations_per_block, std::uint64_t resume_at):
+            file_path(path), block_size(std::max<size_t>(1, generations_per_block))
+    {
+        std::error_code error;
+        if (resume_at != 0 && std::filesystem::exists(path, error) && std::filesystem::file_size(path, error) >= resume_at)
+        {
+            // anything past the offset was written after the checkpoint and will be written again by the resumed run
+            std::filesystem::resize_file(path, resume_at, error);
+            out.open(path, std::ios::binary | std::ios::app);
+            written = resume_at;
+        } else
+        {
+            if (resume_at != 0)
+                BLT_WARN("History file %s is shorter than its checkpoint, starting it again", path.c_str());
+            out.open(path, std::ios::binary | std::ios::trunc);
+            out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+            binary::write(out, HISTORY_FILE_VERSION);
+            binary::write(out, static_cast<std::uint32_t>(population_size));
+            written = sizeof(FILE_MAGIC) + sizeof(HISTORY_FILE_VERSION) + sizeof(std::uint32_t);
+        }
+        if (!out || error)
+            BLT_ERROR("Unable to open history file %s", path.c_str());
+        out.flush();
+        worker = std::thread([this]() { run(); });
+    }
+
+    history_writer::~history_writer()
+    {
+        {
+            std::scoped_lock lock(queue_lock);
+            if (!current.generations.empty())
+                queue.push_back(std::move(current));
+            stopping = true;
+        }
+        queue_cv.notify_one();
+        worker.join();
+    }
+
+    void history_writer::begin(size_t generation)
+    {
+        current.generations.push_back(generation);
+        current.counts.push_back(0);
+    }
+
+    void history_writer::push(const individual_point& p)
+    {
+        current.distance.push_back(p.distance);
+        current.fitness.push_back(p.fitness);
+        current.rank.push_back(p.rank);
+        current.vehicles.push_back(static_cast<std::uint32_t>(p.routes));
+        current.counts.back()++;
+    }
+
+    void history_writer::end()
+    {
+        if (current.generations.size() < block_size)
+            return;
+        {
+            std::scoped_lock lock(queue_lock);
+            queue.push_back(std::move(current));
+        }
+        queue_cv.notify_one();
+        current.clear();
+    }
+
+    std::uint64_t history_writer::sync()
+    {
+        std::unique_lock lock(queue_lock);
+        if (!current.generations.empty())
+        {
+            queue.push_back(std::move(current));
+            current.clear();
+            queue_cv.notify_one();
+        }
+        drained_cv.wait(lock, [this]() { return queue.empty() && !writing; });
+        return written;
+    }
+
+    void history_writer::run()
+    {
+        while (true)
+        {
+            history_block block;
+            {
+                std::unique_lock lock(queue_lock);
+                queue_cv.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                block = std::move(queue.front());
+                queue.pop_front();
+                writing = true;
+            }
+            out.write(BLOCK_MAGIC, sizeof(BLOCK_MAGIC));
+            binary::write(out, static_cast<std::uint32_t>(block.generations.size()));
+            binary::write(out, static_cast<std::uint64_t>(block.distance.size()));
+            binary::write_array(out, block.generations);
+            binary::write_array(out, block.counts);
+            binary::write_array(out, block.distance);
+            binary::write_array(out, block.fitness);
+            binary::write_array(out, block.rank);
+            binary::write_array(out, block.vehicles);
+            // a block on disk is always complete, so a crash can lose at most the blocks still in memory
+            out.flush();
+            {
+                std::scoped_lock lock(queue_lock);
+                written += sizeof(BLOCK_MAGIC) + sizeof(std::uint32_t) + sizeof(std::uint64_t) +
+                           block.generations.size() * (sizeof(std::uint64_t) + sizeof(std::uint32_t)) +
+                           block.distance.size() * (sizeof(double) + sizeof(fitness_t) + sizeof(rank_t) + sizeof(std::uint32_t));
+                writing = false;
+            }
+            drained_cv.notify_all();
+        }
+    }
+
+    history_reader::history_reader(const std::string& path): in(path, std::ios::binary)
+    {
+        char magic[4];
+        std::uint32_t version = 0;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0 || !binary::read(in, version) ||
+            version != HISTORY_FILE_VERSION || !binary::read(in, population))
+        {
+            BLT_ERROR("%s is not a version %d history file", path.c_str(), HISTORY_FILE_VERSION);
+            return;
+        }
+        header_ok = true;
+    }
+
+    bool history_reader::next(history_block& block)
+    {
+        if (!header_ok)
+            return false;
+        char magic[4];
+        std::uint32_t generations = 0;
+        std::uint64_t points = 0;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, BLOCK_MAGIC, sizeof(magic)) != 0 || !binary::read(in, generations) ||
+            !binary::read(in, points) || points > MAX_BLOCK_POINTS)
+            return false;
+        try
+        {
+            return binary::read_array(in, block.generations, generations) && binary::read_array(in, block.counts, generations) &&
+                   binary::read_array(in, block.distance, points) && binary::read_array(in, block.fitness, points) &&
+                   binary::read_array(in, block.rank, points) && binary::read_array(in, block.vehicles, points);
+        } catch (const std::runtime_error& e)
+        {
+            // a block cut short by a crash ends the file like a missing one
+            BLT_WARN("History block ignored: %s", e.what());
+            return false;
+        }
+    }
+
+    void history_reader::for_each(const std::function<void(std::uint64_t, const std::vector<individual_point>&)>& f)
+    {
+        history_block block;
+        std::vector<individual_point> points;
+        while (next(block))
+        {
+            size_t offset = 0;
+            for (size_t i = 0; i < block.generations.size(); i++)
+            {
+                points.clear();
+                for (size_t j = offset; j < offset + block.counts[i] && j < block.distance.size(); j++)
+                    points.push_back({block.distance[j], block.fitness[j], block.rank[j], block.vehicles[j]});
+                offset += block.counts[i];
+                f(block.generations[i], points);
+            }
+        }
+    }
+
+    size_t convert_history(const std::string& binary_path, const std::string& csv_path)
+    {
+        history_reader reader(binary_path);
+        if (!reader.valid())
+            return 0;
+        std::ofstream out(csv_path);
+        out << "Generation,Distance,Fitness,Rank,Routes\n";
+        size_t generations = 0;
+        reader.for_each([&out, &generations](std::uint64_t generation, const std::vector<individual_point>& points) {
+            for (const auto& p : points)
+                out << generation + 1 << ',' << p.distance << ',' << p.fitness << ',' << p.rank << ',' << p.routes << '\n';
+            generations++;
+        });
+        return generations;
+    }
+
+}
@@ -0,0 +1,147 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <islands.h>
+#include <blt/std/logging.h>
+#include <blt/std/format.h>
+#include <algorithm>
+#include <thread>
+
+namespace ga
+{
+    std::string_view to_string(migration_topology topology)
+    {
+        switch (topology)
+        {
+            case migration_topology::RING:
+                return "ring";
+            case migration_topology::RANDOM:
+                return "random";
+        }
+        return "unknown";
+    }
+
+    bool parse_topology(std::string_view str, migration_topology& topology)
+    {
+        for (auto t : {migration_topology::RING, migration_topology::RANDOM})
+        {
+            if (str == to_string(t))
+            {
+                topology = t;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::uint64_t island_seed(std::uint64_t seed, size_t island)
+    {
+        return seed + island * 0x9E3779B97F4A7C15ull;
+    }
+
+    size_t migration_target(migration_topology topology, size_t island, size_t islands, random_engine& engine)
+    {
+        if (topology == migration_topology::RING)
+            return (island + 1) % islands;
+        // any island but this one
+        auto to = static_cast<size_t>(engine.getLong(static_cast<std::uint64_t>(0), static_cast<std::uint64_t>(islands - 2)));
+        return to >= island ? to + 1 : to;
+    }
+
+    island_model::island_model(program& home, island_options options): home(home), options(options)
+    {
+        this->options.islands = std::max<size_t>(this->options.islands, 1);
+        islands.push_back(&home);
+        for (size_t i = 1; i < this->options.islands; i++)
+        {
+            auto island = home.spawn_island(island_seed(home.SEED, i));
+            islands.push_back(island.get());
+            owned.push_back(std::move(island));
+        }
+        // room for one migration from every other island before the owner drains it
+        for (size_t i = 0; i < islands.size(); i++)
+            mailboxes.push_back(std::make_unique<mpmc_queue<individual>>(std::max<size_t>(this->options.migrants * islands.size(), 2)));
+        stats.resize(islands.size());
+    }
+
+    void island_model::run(std::uint64_t generations)
+    {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < islands.size(); i++)
+            threads.emplace_back([this, i, generations]() { run_island(i, generations); });
+        for (auto& t : threads)
+            t.join();
+        for (const auto* island : islands)
+        {
+            for (const auto& [vehicles, distance] : island->getArchive().points())
+                archive.insert(vehicles, distance);
+        }
+    }
+
+    void island_model::run_island(size_t i, std::uint64_t generations)
+    {
+        auto& island = *islands[i];
+        for (std::uint64_t g = 0; g < generations && !island.finished(); g++)
+        {
+            island.executeStep();
+            if (options.interval > 0 && islands.size() > 1 && island.steps() % options.interval == 0)
+                migrate(i);
+        }
+    }
+
+    void island_model::migrate(size_t i)
+    {
+        auto& island = *islands[i];
+        auto& island_stats = stats[i];
+        const auto to = migration_target(options.topology, i, islands.size(), island.engine);
+        for (auto& migrant : island.emigrants(options.migrants))
+        {
+            if (mailboxes[to]->try_push(migrant))
+                island_stats.sent++;
+            else
+                island_stats.dropped++;
+        }
+
+        std::vector<individual> arrived;
+        individual migrant;
+        while (mailboxes[i]->try_pop(migrant))
+            arrived.push_back(std::move(migrant));
+        island_stats.received += arrived.size();
+        island.accept_migrants(arrived);
+    }
+
+    double island_model::getHypervolume() const
+    {
+        return archive.hypervolume(home.instance->reference_vehicles, home.instance->reference_distance);
+    }
+
+    std::vector<std::string> island_model::createTable() const
+    {
+        blt::string::TableFormatter formatter{"Islands (" + std::string(to_string(options.topology)) + ", " + std::to_string(options.migrants) +
+                                              " migrants every " + std::to_string(options.interval) + " generations)"};
+        formatter.addColumn({"Island"});
+        formatter.addColumn({"Generations"});
+        formatter.addColumn({"Fewest Vehicles"});
+        formatter.addColumn({"Shortest Distance"});
+        formatter.addColumn({"Archive"});
+        formatter.addColumn({"Hypervolume"});
+        formatter.addColumn({"Sent/Received/Dropped"});
+        for (size_t i = 0; i < islands.size(); i++)
+        {
+            const auto* island = islands[i];
+            const auto& points = island->getArchive().points();
+            formatter.addRow({std::to_string(i), std::to_string(island->steps()),
+                              points.empty() ? "-" : std::to_string(static_cast<int>(points.front().first)),
+                              points.empty() ? "-" : std::to_string(points.back().second), std::to_string(points.size()),
+                              std::to_string(island->getArchive().hypervolume(home.instance->reference_vehicles, home.instance->reference_distance)),
+                              std::to_string(stats[i].sent) + "/" + std::to_string(stats[i].received) + "/" + std::to_string(stats[i].dropped)});
+        }
+        const auto& points = archive.points();
+        formatter.addRow({"merged", "-", points.empty() ? "-" : std::to_string(static_cast<int>(points.front().first)),
+                          points.empty() ? "-" : std::to_string(points.back().second), std::to_string(points.size()),
+                          std::to_string(getHypervolume()), "-"});
+        return formatter.createTable(true, true);
+    }
+
+}
@@ -2,10 +2,13 @@
 // Created by brett on 09/10/23.
 //
 #include <loader.h>
+#include <blt/std/logging.h>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iterator>
+#include <filesystem>
+#include <stdexcept>
 
 std::vector<record> load_problem(const std::string& path)
 {
@@ -25,3 +28,51 @@ std::vector<record> load_problem(const std::string& path)
     
     return records;
 }
+
+std::int32_t solomon_capacity(const std::string& path)
+{
+    auto name = std::filesystem::path(path).stem().string();
+    // the class is the letters up to the first digit, the series is that digit
+    auto series = name.find_first_of("0123456789");
+    if (series == std::string::npos)
+        return 200;
+    if (name[series] == '1')
+        return 200;
+    return name.substr(0, series) == "c" ? 700 : 1000;
+}
+
+std::unordered_map<std::string, best_known> load_best_known(const std::string& path)
+{
+    std::unordered_map<std::string, best_known> known;
+    std::ifstream input(path);
+    if (!input.is_open())
+    {
+        BLT_WARN("Unable to open best known solutions %s, no run will reach a best known target", path.c_str());
+        return known;
+    }
+    
+    // header
+    std::string line;
+    std::getline(input, line);
+    size_t line_number = 1;
+    
+    while (std::getline(input, line))
+    {
+        line_number++;
+        if (line.empty())
+            continue;
+        std::istringstream stream(line);
+        std::string instance, vehicles, distance;
+        try
+        {
+            if (!std::getline(stream, instance, ',') || !std::getline(stream, vehicles, ',') || !std::getline(stream, distance, ','))
+                throw std::invalid_argument(line);
+            known[instance] = {std::stoi(vehicles), std::stod(distance)};
+        } catch (const std::exception&)
+        {
+            BLT_WARN("%s:%d: expected instance,vehicles,distance, the row is skipped", path.c_str(), line_number);
+        }
+    }
+    
+    return known;
+}
@@ -1,6 +1,11 @@
 #include <iostream>
 
 #include <program.h>
+#include <async.h>
+#include <islands.h>
+#include <process_islands.h>
+#include <batch.h>
+#include <trace.h>
 #include <blt/parse/argparse.h>
 #include <blt/std/logging.h>
 #include <blt/std/system.h>
@@ -26,25 +31,25 @@
 #include <thread>
 #include <mutex>
 #include <barrier>
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
 #include <ostream>
 #include <fstream>
+#include <limits>
+#include <cmath>
 
-struct datagram
+// the whole argument as a finite number of at least 0, std::stod alone takes trailing text, nan and inf
+static bool parse_non_negative(const std::string& str, double& out)
 {
-    int32_t capacity;
-    std::vector<std::string> problems;
-};
-
-namespace blt
-{
-    inline std::string filename(const std::string& path)
+    try
+    {
+        size_t end = 0;
+        out = std::stod(str, &end);
+        return end == str.size() && std::isfinite(out) && out >= 0;
+    } catch (const std::exception&)
     {
-        auto paths = blt::string::split(path, "/");
-        auto final = paths[paths.size() - 1];
-        if (final == "/")
-            return paths[paths.size() - 2];
-        return final;
+        return false;
     }
 }
 
@@ -58,6 +63,90 @@ int main(int argc, const char** argv)
     parser.addArgument(blt::arg_builder("--problemset", "-p").setAction(blt::arg_action_t::STORE).setNArgs(1)
                                                              .setHelp("Set where to load the problem set from, defaults to r101")
                                                              .setDefault("../problems/r101.set").build());
+    parser.addArgument(blt::arg_builder("--objective", "-o").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                            .setHelp("Objective of the interactive run: pareto, weighted_sum or lexicographic. (Default: pareto)")
+                                                            .setDefault("pareto").build());
+    parser.addArgument(blt::arg_builder("--pareto-objectives").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                              .setHelp("Comma separated objectives the pareto ranking minimises: vehicles, distance, waiting, imbalance. (Default: vehicles,distance)")
+                                                              .setDefault("vehicles,distance").build());
+    parser.addArgument(blt::arg_builder("--stagnation").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("Stop the interactive run once neither the pareto archive nor the best fitness improved for this many generations. (Default: 0, off)")
+                                                       .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--time-budget").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                        .setHelp("Stop the interactive run after this many seconds of stepping. (Default: 0, off)")
+                                                        .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--evaluation-budget").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                              .setHelp("Stop the interactive run after this many individuals were evaluated. (Default: 0, off)")
+                                                              .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--step-mode").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                      .setHelp("How the interactive run replaces its population: generational or steady_state. (Default: generational)")
+                                                      .setDefault("generational").build());
+    parser.addArgument(blt::arg_builder("--producers").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                      .setHelp("Breed the interactive run's offspring on this many threads while others evaluate them, with no generation barrier. Implies steady_state. (Default: 0, off)")
+                                                      .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--evaluators").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("Threads decoding and scoring offspring when --producers is on. (Default: 1)")
+                                                       .setDefault("1").build());
+    parser.addArgument(blt::arg_builder("--islands").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                    .setHelp("Solve the interactive run's instance with this many sub-populations on their own threads, the run is island 0. (Default: 1, off)")
+                                                    .setDefault("1").build());
+    parser.addArgument(blt::arg_builder("--processes").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                      .setHelp("Fork this many island processes on the instance instead of starting the REPL, write their merged front and exit. Uses the migration options of --islands. (Default: 0, off)")
+                                                      .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--migration-interval").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                               .setHelp("Generations between two migrations of the islands, 0 never migrates. (Default: 10)")
+                                                               .setDefault("10").build());
+    parser.addArgument(blt::arg_builder("--migrants").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                     .setHelp("Front members an island sends per migration. (Default: 2)")
+                                                     .setDefault("2").build());
+    parser.addArgument(blt::arg_builder("--topology").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                     .setHelp("Where the islands send migrants: ring or random. (Default: ring)")
+                                                     .setDefault("ring").build());
+    parser.addArgument(blt::arg_builder("--immigrants").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("Set to 1 to replace clones with random immigrants, each generation or in steady state each offspring that copies a member. (Default: 0)")
+                                                       .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--trace", "-t").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                        .setHelp("Record a chrome://tracing timeline of every run into this file. (Default: off)")
+                                                        .setDefault("").build());
+    parser.addArgument(blt::arg_builder("--history", "-H").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                          .setHelp("Per individual history to keep: full, every:<k>, rank1 or ring:<m>. (Default: full)")
+                                                          .setDefault("full").build());
+    parser.addArgument(blt::arg_builder("--stream", "-s").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                         .setHelp("Stream every generation to this binary history file, batch runs get the instance and run appended. (Default: off)")
+                                                         .setDefault("").build());
+    parser.addArgument(blt::arg_builder("--resume", "-R").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                         .setHelp("Continue the run saved in this checkpoint file instead of starting a new one. (Default: off)")
+                                                         .setDefault("").build());
+    parser.addArgument(blt::arg_builder("--checkpoint-every", "-k").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                                   .setHelp("Checkpoint every batch run each k generations, interrupted runs resume on the next batch. (Default: 0, off)")
+                                                                   .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--checkpoint-dir").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                           .setHelp("Where batch checkpoints are kept. (Default: ./checkpoints)")
+                                                           .setDefault("./checkpoints").build());
+    parser.addArgument(blt::arg_builder("--manifest", "-m").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                           .setHelp("Batch manifest listing the instances, capacities, runs, GA parameters and seeds of the sweep. (Default: ../problems/default.manifest)")
+                                                           .setDefault("../problems/default.manifest").build());
+    parser.addArgument(blt::arg_builder("--cache").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                  .setHelp("Directory of cached seeded batch runs, reused whenever a sweep repeats the same work, 'off' to disable. (Default: ./cache)")
+                                                  .setDefault("./cache").build());
+    parser.addArgument(blt::arg_builder("--ci").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                               .setHelp("Stop running a batch instance once the 95% confidence interval of every mean is within this fraction of it, e.g. 0.01. (Default: 0, off)")
+                                               .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--ci-min-runs").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                        .setHelp("Fewest runs an instance needs before --ci can stop it. (Default: 10)")
+                                                        .setDefault("10").build());
+    parser.addArgument(blt::arg_builder("--journal", "-j").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                          .setHelp("Batch results are journaled here as they finish, a restarted batch skips the runs it already has with the same settings. (Default: ./batch_journal.csv)")
+                                                          .setDefault("./batch_journal.csv").build());
+    parser.addArgument(blt::arg_builder("--known").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                  .setHelp("Best known solutions the batch measures time to target against. (Default: ../problems/best_known.csv)")
+                                                  .setDefault("../problems/best_known.csv").build());
+    parser.addArgument(blt::arg_builder("--pin-threads").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                        .setHelp("Set to 1 to pin every batch worker to a CPU and keep each NUMA node's runs and instance copies on its own workers. (Default: 0)")
+                                                        .setDefault("0").build());
+    parser.addArgument(blt::arg_builder("--target-gap").setAction(blt::arg_action_t::STORE).setNArgs(1)
+                                                       .setHelp("A batch run reaches the best known target within this fraction of its distance. (Default: 0.05)")
+                                                       .setDefault("0.05").build());
 
 #ifdef BLT_BUILD_GLFW
     blt::init_glfw();
@@ -65,9 +154,148 @@ int main(int argc, const char** argv)
     
     auto args = parser.parse_args(argc, argv);
     
-    auto loaded_problems = load_problem(args.get<std::string>("problemset"));
+    if (!args.get<std::string>("trace").empty())
+        ga::trace::enable(args.get<std::string>("trace"));
     
-    ga::program p(args.get<int32_t>("capacity"), std::move(loaded_problems));
+    const auto history_config = ga::history_config::parse(args.get<std::string>("history"));
+    const auto stream_path = args.get<std::string>("stream");
+    const auto resume_path = args.get<std::string>("resume");
+    const auto checkpoint_every = static_cast<size_t>(std::max(0, args.get<int32_t>("checkpoint-every")));
+    const auto checkpoint_dir = args.get<std::string>("checkpoint-dir");
+    
+    // the launcher's program is only the template of the islands, none of these would reach them. A history writer would also have its
+    // thread running across the forks
+    if (args.get<int32_t>("processes") > 0)
+    {
+        if (!resume_path.empty())
+        {
+            BLT_ERROR("--processes can not be combined with --resume, every island starts a new run");
+            return 1;
+        }
+        if (args.get<int32_t>("producers") > 0)
+        {
+            BLT_ERROR("--processes and --producers can not be combined");
+            return 1;
+        }
+        if (!stream_path.empty())
+        {
+            BLT_ERROR("--processes and --stream can not be combined, island processes do not stream their history");
+            return 1;
+        }
+    }
+    
+    auto p = [&]() -> ga::program {
+        if (!resume_path.empty())
+        {
+            try
+            {
+                return ga::program(resume_path);
+            } catch (const std::runtime_error& e)
+            {
+                BLT_ERROR(e.what());
+                std::exit(1);
+            }
+        }
+        ga::objective_mode objective;
+        if (!ga::parse_objective(args.get<std::string>("objective"), objective))
+        {
+            BLT_ERROR("Unknown objective %s", args.get<std::string>("objective").c_str());
+            std::exit(1);
+        }
+        return ga::program(args.get<int32_t>("capacity"), load_problem(args.get<std::string>("problemset")), objective);
+    }();
+    // a resumed run keeps the history and stream it was checkpointed with
+    if (resume_path.empty())
+    {
+        p.setHistoryPolicy(history_config);
+        std::vector<ga::objective_id> pareto_objectives;
+        if (!ga::parse_objectives(args.get<std::string>("pareto-objectives"), pareto_objectives))
+        {
+            BLT_ERROR("Unknown or too few pareto objectives in %s", args.get<std::string>("pareto-objectives").c_str());
+            return 1;
+        }
+        p.setParetoObjectives(std::move(pareto_objectives));
+        // the interactive run has never stopped at GENERATION_COUNT, only the criteria asked for end it
+        ga::termination_criteria termination;
+        termination.generations = std::numeric_limits<std::uint64_t>::max();
+        try
+        {
+            termination.stagnation = std::stoull(args.get<std::string>("stagnation"));
+            termination.time_budget = std::stod(args.get<std::string>("time-budget"));
+            termination.evaluation_budget = std::stoull(args.get<std::string>("evaluation-budget"));
+        } catch (const std::exception&)
+        {
+            BLT_ERROR("Invalid termination criteria");
+            return 1;
+        }
+        p.setTermination(termination);
+        p.setCloneImmigrants(args.get<int32_t>("immigrants") != 0);
+        ga::step_mode stepping;
+        if (!ga::parse_step_mode(args.get<std::string>("step-mode"), stepping))
+        {
+            BLT_ERROR("Unknown step mode %s", args.get<std::string>("step-mode").c_str());
+            return 1;
+        }
+        p.setStepMode(stepping);
+        if (!stream_path.empty())
+            p.streamHistory(stream_path);
+    } else
+        BLT_INFO("Resumed %s at generation %d", resume_path.c_str(), p.steps());
+    
+    // the batch only starts from the REPL, its options are checked here so a bad one stops the program before any work is done
+    double ci_target = 0;
+    if (!parse_non_negative(args.get<std::string>("ci"), ci_target))
+    {
+        BLT_ERROR("Invalid --ci %s, expected a fraction of 0 or more", args.get<std::string>("ci").c_str());
+        return 1;
+    }
+    double target_gap = 0;
+    if (!parse_non_negative(args.get<std::string>("target-gap"), target_gap))
+    {
+        BLT_ERROR("Invalid --target-gap %s, expected a fraction of 0 or more", args.get<std::string>("target-gap").c_str());
+        return 1;
+    }
+    
+    std::unique_ptr<ga::async_runner> runner;
+    if (args.get<int32_t>("producers") > 0)
+    {
+        ga::async_options async;
+        async.producers = static_cast<size_t>(args.get<int32_t>("producers"));
+        async.evaluators = static_cast<size_t>(std::max(args.get<int32_t>("evaluators"), 1));
+        runner = std::make_unique<ga::async_runner>(p, async);
+    }
+    ga::island_options island;
+    island.interval = static_cast<size_t>(std::max(args.get<int32_t>("migration-interval"), 0));
+    island.migrants = static_cast<size_t>(std::max(args.get<int32_t>("migrants"), 0));
+    if (!ga::parse_topology(args.get<std::string>("topology"), island.topology))
+    {
+        BLT_ERROR("Unknown topology %s", args.get<std::string>("topology").c_str());
+        return 1;
+    }
+    if (args.get<int32_t>("processes") > 0)
+    {
+        // the launcher, every island runs in its own process and the REPL is never started
+        island.islands = static_cast<size_t>(args.get<int32_t>("processes"));
+        ga::process_islands launcher(p, island);
+        const bool finished = launcher.run(static_cast<std::uint64_t>(p.GENERATION_COUNT));
+        for (const auto& v : launcher.createTable())
+            BLT_INFO(v);
+        const auto front_path = "./ga_islands_" + blt::system::getTimeStringFS() + ".csv";
+        if (launcher.writeFront(front_path))
+            BLT_INFO("Merged front written to %s", front_path.c_str());
+        return finished ? 0 : 1;
+    }
+    std::unique_ptr<ga::island_model> islands;
+    if (args.get<int32_t>("islands") > 1)
+    {
+        if (runner)
+        {
+            BLT_ERROR("--islands and --producers can not be combined");
+            return 1;
+        }
+        island.islands = static_cast<size_t>(args.get<int32_t>("islands"));
+        islands = std::make_unique<ga::island_model>(p, island);
+    }
     
     std::int32_t skip = 0;
     
@@ -75,8 +303,28 @@ int main(int argc, const char** argv)
     
     while (true)
     {
+        if (islands && skip > 0)
+        {
+            islands->run(static_cast<std::uint64_t>(skip));
+            skip = 0;
+            for (const auto& v : islands->createTable())
+                BLT_INFO(v);
+        }
+        if (runner && skip > 0)
+        {
+            runner->run(static_cast<std::uint64_t>(skip));
+            skip = 0;
+            if (p.finished())
+                BLT_INFO("Stopped by %s at generation %d", std::string(ga::to_string(p.stopReason())).c_str(), p.steps());
+        }
         while (skip-- > 0)
         {
+            if (p.finished())
+            {
+                BLT_INFO("Stopped by %s at generation %d", std::string(ga::to_string(p.stopReason())).c_str(), p.steps());
+                skip = 0;
+                break;
+            }
             p.executeStep();
         }
         BLT_INFO("What do we do(%d/%d)? ", p.steps(), p.GENERATION_COUNT);
@@ -88,6 +336,55 @@ int main(int argc, const char** argv)
             skip = std::stoi(whatToDo);
         } else
         {
+            // commands that take a path are matched on their first word alone so the path keeps its case and may hold any letter
+            const auto command_args = blt::string::split(whatToDo, ' ');
+            const auto command = command_args.empty() ? std::string{} : blt::string::toLowerCase(command_args[0]);
+            if (command == "stream")
+            {
+                // stream <path> | stream off
+                if (command_args.size() > 1 && blt::string::toLowerCase(command_args[1]) == "off")
+                    p.stopStreamingHistory();
+                else
+                    p.streamHistory(command_args.size() > 1 ? command_args[1] : "./ga_history_" + blt::system::getTimeStringFS() + ".vrph");
+                continue;
+            } else if (command == "checkpoint")
+            {
+                // checkpoint [path]
+                const auto checkpoint_path = command_args.size() > 1 ? command_args[1] : "./ga_checkpoint_" + blt::system::getTimeStringFS() + ".ckpt";
+                if (p.checkpoint(checkpoint_path))
+                    BLT_INFO("Saved generation %d to %s", p.steps(), checkpoint_path.c_str());
+                continue;
+            } else if (command == "convert")
+            {
+                // convert <history file> [csv file]
+                if (command_args.size() < 2)
+                {
+                    BLT_INFO("Usage: convert <history file> [csv file]");
+                    continue;
+                }
+                const auto csv_path = command_args.size() > 2 ? command_args[2] : command_args[1] + ".csv";
+                BLT_INFO("Converted %d generations to %s", ga::convert_history(command_args[1], csv_path), csv_path.c_str());
+                continue;
+            } else if (command == "profile")
+            {
+                // profile [csv <path>]
+                if (command_args.size() > 1 && blt::string::toLowerCase(command_args[1]) == "csv")
+                {
+                    std::ofstream out(command_args.size() > 2 ? command_args[2] : "./profile_" + blt::system::getTimeStringFS() + ".csv");
+                    ga::phase_profile::writeCSVHeader(out);
+                    p.getProfile().writeCSV(out, "run");
+                } else
+                {
+                    for (const auto& v : p.getProfile().createTable("Step Profile (" + std::to_string(p.steps()) + " generations)"))
+                        BLT_INFO(v);
+                }
+                continue;
+            } else if (command == "w" || command == "write")
+            {
+                // w [path]
+                p.write(whatToDo);
+                continue;
+            }
             whatToDo = blt::string::toLowerCase(whatToDo);
             if (whatToDo == "exit" || blt::string::contains(whatToDo, 'q'))
                 return 0;
@@ -103,210 +400,20 @@ int main(int argc, const char** argv)
                 p.reset();
             else if (blt::string::contains(whatToDo, "t"))
             {
-                std::queue<datagram> data;
-                data.emplace(
-                        200,
-                        std::vector<std::string>{
-                                "../problems/r101.set",
-                                "../problems/r102.set",
-                                "../problems/r103.set",
-                                "../problems/r104.set",
-                                "../problems/r105.set",
-                                "../problems/r106.set",
-                                "../problems/r107.set",
-                                "../problems/r108.set",
-                                "../problems/r109.set",
-                                "../problems/r110.set",
-                                "../problems/r111.set",
-                                "../problems/c101.set",
-                                "../problems/c102.set",
-                                "../problems/c103.set",
-                                "../problems/c104.set",
-                                "../problems/c105.set",
-                                "../problems/c106.set",
-                                "../problems/c107.set",
-                                "../problems/c108.set",
-                                "../problems/rc101.set",
-                                "../problems/rc102.set",
-                                "../problems/rc103.set",
-                                "../problems/rc104.set",
-                                "../problems/rc105.set",
-                                "../problems/rc106.set",
-                                "../problems/rc107.set",
-                                "../problems/rc108.set",
-                        }
-                );
-                data.emplace(
-                        1000,
-                        std::vector<std::string>{
-                                "../problems/r201.set",
-                                "../problems/r202.set",
-                                "../problems/r203.set",
-                                "../problems/r204.set",
-                                "../problems/r205.set",
-                                "../problems/r206.set",
-                                "../problems/r207.set",
-                                "../problems/r208.set",
-                                "../problems/r209.set",
-                                "../problems/r210.set",
-                                "../problems/r211.set",
-                                "../problems/rc201.set",
-                                "../problems/rc202.set",
-                                "../problems/rc203.set",
-                                "../problems/rc204.set",
-                                "../problems/rc205.set",
-                                "../problems/rc206.set",
-                                "../problems/rc207.set",
-                                "../problems/rc208.set"
-                        }
-                );
-                data.emplace(
-                        700,
-                        std::vector<std::string>{
-                                "../problems/c101.set",
-                                "../problems/c102.set",
-                                "../problems/c103.set",
-                                "../problems/c104.set",
-                                "../problems/c105.set",
-                                "../problems/c106.set",
-                                "../problems/c107.set",
-                                "../problems/c108.set"
-                        }
-                );
-                std::mutex read_lock;
-                std::mutex write_lock;
-                
-                struct table_record
-                {
-                    std::string instance;
-                    std::string wGA;
-                    std::string pGAVehicles;
-                    std::string pGACost;
-                    
-                    [[nodiscard]] inline blt::string::TableRow toRow() const
-                    {
-                        return {{instance, wGA, pGAVehicles, pGACost}};
-                    }
-                };
-                
-                std::vector<table_record> average_records;
-                std::vector<table_record> best_records;
-                
-                const size_t runs = 50;
-                auto processor_count = std::thread::hardware_concurrency();
-                std::barrier sync(processor_count + 1);
-                
-                blt::string::TableFormatter formatter_average{"Average Of " + std::to_string(runs)};
-                formatter_average.addColumn({"Instance"});
-                formatter_average.addColumn({"wGA"});
-                formatter_average.addColumn({"pGA Vehicles"});
-                formatter_average.addColumn({"pGA Distance"});
-                
-                blt::string::TableFormatter formatter_best{"Best Of " + std::to_string(runs)};
-                formatter_best.addColumn({"Instance"});
-                formatter_best.addColumn({"wGA"});
-                formatter_best.addColumn({"pGA Vehicles"});
-                formatter_best.addColumn({"pGA Distance"});
-                
-                std::vector<std::jthread*> threads;
-                for (size_t i = 0; i < processor_count; i++)
-                {
-                    threads.push_back(new std::jthread([&, i]() -> void {
-                        BLT_INFO("Starting thread %d", i);
-                        while (true)
-                        {
-                            std::string problem;
-                            int32_t capacity = 0;
-                            {
-                                std::scoped_lock<std::mutex> l(read_lock);
-                                if (data.empty())
-                                    break;
-                                auto& p = data.front();
-                                problem = p.problems.back();
-                                p.problems.pop_back();
-                                if (p.problems.empty())
-                                    data.pop();
-                                BLT_DEBUG("new size is %d with left in queue %d", p.problems.size(), data.size());
-                                capacity = p.capacity;
-                            }
-                            
-                            ga::individual_point bestCars = ga::individual_point::max();
-                            ga::individual_point bestDistance = ga::individual_point::max();
-                            ga::individual_point bestFitness = ga::individual_point::max();
-                            
-                            ga::individual_point averageCars;
-                            ga::individual_point averageDistance;
-                            ga::individual_point averageFitness;
-                            for (size_t j = 0; j < runs; j++)
-                            {
-                                BLT_TRACE("%d Executing run %d", i, j);
-                                ga::program p(capacity, load_problem(problem));
-                                
-                                for (int k = 0; k < ga::DEFAULT_GENERATION_COUNT; k++)
-                                    p.executeStep();
-                                
-                                auto bc = p.getBestCars();
-                                auto bd = p.getBestDistance();
-                                auto bf = p.getBestFitness();
-                                
-                                averageCars += bc;
-                                averageDistance += bd;
-                                averageFitness += bf;
-                                
-                                if (bc.routes < bestCars.routes)
-                                    bestCars = bc;
-                                if (bd.distance < bestDistance.distance)
-                                    bestDistance = bd;
-                                if (bf.fitness < bestFitness.fitness)
-                                    bestFitness = bf;
-                                BLT_TRACE("%d Ending run %d", i, j);
-                                BLT_WARN(std::to_string(bf.routes) + " " + std::to_string(bf.distance));
-                                BLT_WARN(std::to_string(bc.routes) + " " + std::to_string(bc.distance));
-                                BLT_WARN(std::to_string(bd.routes) + " " + std::to_string(bd.distance));
-                            }
-                            averageCars /= runs;
-                            averageDistance /= runs;
-                            averageFitness /= runs;
-                            
-                            BLT_WARN(std::to_string(averageFitness.routes) + " " + std::to_string(averageFitness.distance));
-                            BLT_WARN(std::to_string(averageCars.routes) + " " + std::to_string(averageCars.distance));
-                            BLT_WARN(std::to_string(averageDistance.routes) + " " + std::to_string(averageDistance.distance));
-                            
-                            {
-                                std::scoped_lock<std::mutex> lo(write_lock);
-                                formatter_average.addRow({blt::filename(problem),
-                                                          std::to_string(averageFitness.routes) + " " + std::to_string(averageFitness.distance),
-                                                          std::to_string(averageCars.routes) + " " + std::to_string(averageCars.distance),
-                                                          std::to_string(averageDistance.routes) + " " + std::to_string(averageDistance.distance)});
-                                
-                                formatter_best.addRow({blt::filename(problem),
-                                                       std::to_string(bestFitness.routes) + " " + std::to_string(bestFitness.distance),
-                                                       std::to_string(bestCars.routes) + " " + std::to_string(bestCars.distance),
-                                                       std::to_string(bestDistance.routes) + " " + std::to_string(bestDistance.distance)});
-                            }
-                        }
-                        
-                        BLT_INFO("Ending thread %d", i);
-                        sync.arrive_and_wait();
-                    }));
-                }
-                sync.arrive_and_wait();
-                for (auto* v : threads)
-                    delete v;
-                
-                BLT_TRACE("Threads deleted.");
-                
-                std::ofstream lout("results.txt");
-                for (const auto& v : formatter_average.createTable(true, true))
-                {
-                    std::cout << v << "\n";
-                    lout << v << "\n";
-                }
-                for (const auto& v : formatter_best.createTable(true, true))
-                {
-                    std::cout << v << "\n";
-                    lout << v << "\n";
-                }
+                ga::batch_options options;
+                options.manifest_path = args.get<std::string>("manifest");
+                options.history = history_config;
+                options.stream_path = stream_path;
+                options.checkpoint_every = checkpoint_every;
+                options.checkpoint_dir = checkpoint_dir;
+                options.journal_path = args.get<std::string>("journal");
+                options.ci_target = ci_target;
+                options.ci_min_runs = static_cast<size_t>(std::max(2, args.get<int32_t>("ci-min-runs")));
+                options.cache_dir = args.get<std::string>("cache") == "off" ? "" : args.get<std::string>("cache");
+                options.known_path = args.get<std::string>("known");
+                options.target_gap = target_gap;
+                options.pin_threads = args.get<int32_t>("pin-threads") != 0;
+                ga::run_batch(options);
             } else
             {
                 BLT_INFO("Not a command.");
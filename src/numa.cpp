@@ -0,0 +1,116 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <numa.h>
+#include <blt/std/logging.h>
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+
+namespace ga
+{
+    static bool parse_cpu(std::string_view str, std::int32_t& cpu)
+    {
+        const auto* end = str.data() + str.size();
+        auto [ptr, error] = std::from_chars(str.data(), end, cpu);
+        return error == std::errc{} && ptr == end && cpu >= 0;
+    }
+
+    bool parse_cpu_list(std::string_view str, std::vector<std::int32_t>& cpus)
+    {
+        std::vector<std::int32_t> parsed;
+        while (!str.empty() && (str.back() == '\n' || str.back() == ' '))
+            str.remove_suffix(1);
+        while (!str.empty())
+        {
+            const auto comma = str.find(',');
+            const auto range = str.substr(0, comma);
+            str = comma == std::string_view::npos ? std::string_view{} : str.substr(comma + 1);
+            const auto dash = range.find('-');
+            std::int32_t first = 0, last = 0;
+            if (!parse_cpu(range.substr(0, dash), first))
+                return false;
+            last = first;
+            if (dash != std::string_view::npos && (!parse_cpu(range.substr(dash + 1), last) || last < first))
+                return false;
+            for (auto cpu = first; cpu <= last; cpu++)
+                parsed.push_back(cpu);
+        }
+        cpus = std::move(parsed);
+        return true;
+    }
+
+    static std::vector<std::int32_t> allowed_cpus()
+    {
+        std::vector<std::int32_t> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (std::int32_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            {
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+            }
+        }
+        if (cpus.empty())
+        {
+            for (std::int32_t cpu = 0; cpu < static_cast<std::int32_t>(std::max(1u, std::thread::hardware_concurrency())); cpu++)
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    std::vector<numa_node> numa_topology()
+    {
+        const auto allowed = allowed_cpus();
+        std::vector<numa_node> nodes;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error))
+        {
+            const auto name = entry.path().filename().string();
+            numa_node node;
+            if (!name.starts_with("node") || !parse_cpu(std::string_view(name).substr(4), node.id))
+                continue;
+            std::ifstream in(entry.path() / "cpulist");
+            std::string list;
+            std::getline(in, list);
+            std::vector<std::int32_t> cpus;
+            if (!parse_cpu_list(list, cpus))
+            {
+                BLT_WARN("Could not read the CPUs of NUMA node %d", node.id);
+                continue;
+            }
+            std::copy_if(cpus.begin(), cpus.end(), std::back_inserter(node.cpus), [&allowed](std::int32_t cpu) {
+                return std::binary_search(allowed.begin(), allowed.end(), cpu);
+            });
+            if (!node.cpus.empty())
+                nodes.push_back(std::move(node));
+        }
+        if (nodes.empty())
+            nodes.push_back({0, allowed});
+        std::sort(nodes.begin(), nodes.end(), [](const numa_node& a, const numa_node& b) { return a.id < b.id; });
+        return nodes;
+    }
+
+    bool pin_current_thread(std::int32_t cpu)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    std::int32_t current_cpu()
+    {
+        return sched_getcpu();
+    }
+
+}
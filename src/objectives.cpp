@@ -0,0 +1,320 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <objectives.h>
+#include <blt/std/string.h>
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+namespace ga
+{
+    static constexpr std::array<objective_id, MAX_OBJECTIVES> ALL_OBJECTIVES{
+            objective_id::VEHICLES, objective_id::DISTANCE, objective_id::WAITING, objective_id::IMBALANCE
+    };
+
+    std::string_view to_string(objective_id id)
+    {
+        switch (id)
+        {
+            case objective_id::VEHICLES:
+                return "vehicles";
+            case objective_id::DISTANCE:
+                return "distance";
+            case objective_id::WAITING:
+                return "waiting";
+            case objective_id::IMBALANCE:
+                return "imbalance";
+        }
+        return "unknown";
+    }
+
+    std::vector<objective_id> default_objectives()
+    {
+        return {objective_id::VEHICLES, objective_id::DISTANCE};
+    }
+
+    bool parse_objectives(std::string_view str, std::vector<objective_id>& ids)
+    {
+        std::vector<objective_id> parsed;
+        for (const auto& name : blt::string::split(std::string(str), ','))
+        {
+            auto found = std::find_if(ALL_OBJECTIVES.begin(), ALL_OBJECTIVES.end(), [&name](objective_id id) { return to_string(id) == name; });
+            if (found == ALL_OBJECTIVES.end() || std::find(parsed.begin(), parsed.end(), *found) != parsed.end())
+                return false;
+            parsed.push_back(*found);
+        }
+        if (parsed.size() < 2)
+            return false;
+        ids = std::move(parsed);
+        return true;
+    }
+
+    std::string to_string(const std::vector<objective_id>& ids)
+    {
+        std::string str;
+        for (auto id : ids)
+        {
+            if (!str.empty())
+                str += ',';
+            str += to_string(id);
+        }
+        return str;
+    }
+
+    double hypervolume_2d(std::vector<std::pair<double, double>>& points, double reference_x, double reference_y)
+    {
+        std::sort(points.begin(), points.end());
+        // walk the staircase left to right, each step covers up to the next point that improves y, the last one up to the reference x
+        double volume = 0;
+        double step_x = 0;
+        double step_y = reference_y;
+        for (const auto& [x, y] : points)
+        {
+            if (x >= reference_x)
+                break;
+            if (y >= step_y)
+                continue;
+            if (step_y < reference_y)
+                volume += (x - step_x) * (reference_y - step_y);
+            step_x = x;
+            step_y = y;
+        }
+        if (step_y < reference_y)
+            volume += (reference_x - step_x) * (reference_y - step_y);
+        return volume;
+    }
+
+    bool pareto_archive::insert(double vehicles, double distance)
+    {
+        // the first archived point with more vehicles, everything before it has as many or fewer
+        auto after = std::upper_bound(front.begin(), front.end(), vehicles, [](double v, const std::pair<double, double>& p) {
+            return v < p.first;
+        });
+        // the closest point to the left has the lowest distance of those, if it is no worse the new point adds nothing
+        if (after != front.begin() && std::prev(after)->second <= distance)
+            return false;
+        // a point on the same vehicle count with a higher distance is dominated, as is everything to the right that is no better
+        auto first = after;
+        while (first != front.begin() && std::prev(first)->first == vehicles)
+            --first;
+        auto last = after;
+        while (last != front.end() && last->second >= distance)
+            ++last;
+        front.insert(front.erase(first, last), {vehicles, distance});
+        return true;
+    }
+
+    double pareto_archive::hypervolume(double reference_x, double reference_y) const
+    {
+        auto points = front;
+        return hypervolume_2d(points, reference_x, reference_y);
+    }
+
+    void objective_matrix::reset(size_t objectives, size_t individuals)
+    {
+        k = objectives;
+        n = individuals;
+        values.resize(k * n);
+    }
+
+    bool objective_matrix::dominates(size_t u, size_t v) const
+    {
+        bool strictly = false;
+        for (size_t j = 0; j < k; j++)
+        {
+            const auto* c = column(j);
+            if (c[u] > c[v])
+                return false;
+            strictly |= c[u] < c[v];
+        }
+        return strictly;
+    }
+
+    void objective_matrix::dominated_by(size_t u, std::uint8_t* out, std::uint8_t* strict) const
+    {
+        std::fill(out, out + n, 1);
+        std::fill(strict, strict + n, 0);
+        for (size_t j = 0; j < k; j++)
+        {
+            const auto* c = column(j);
+            const auto x = c[u];
+            for (size_t v = 0; v < n; v++)
+            {
+                out[v] &= static_cast<std::uint8_t>(x <= c[v]);
+                strict[v] |= static_cast<std::uint8_t>(x < c[v]);
+            }
+        }
+        for (size_t v = 0; v < n; v++)
+            out[v] &= strict[v];
+    }
+
+    std::uint64_t non_dominated_sorter::sort(const objective_matrix& m, std::vector<rank_t>& ranks)
+    {
+        const auto n = m.size();
+        dominance.resize(n * n);
+        strict.resize(n);
+        dominated_count.assign(n, 0);
+        ranks.assign(n, 0);
+
+        for (size_t u = 0; u < n; u++)
+        {
+            auto* row = dominance.data() + u * n;
+            m.dominated_by(u, row, strict.data());
+            for (size_t v = 0; v < n; v++)
+                dominated_count[v] += row[v];
+        }
+
+        front.clear();
+        for (size_t u = 0; u < n; u++)
+        {
+            if (dominated_count[u] == 0)
+                front.push_back(static_cast<std::uint32_t>(u));
+        }
+        rank_t rank = 1;
+        while (!front.empty())
+        {
+            next_front.clear();
+            for (auto u : front)
+            {
+                ranks[u] = rank;
+                const auto* row = dominance.data() + static_cast<size_t>(u) * n;
+                for (size_t v = 0; v < n; v++)
+                {
+                    if (row[v] && --dominated_count[v] == 0)
+                        next_front.push_back(static_cast<std::uint32_t>(v));
+                }
+            }
+            std::swap(front, next_front);
+            rank++;
+        }
+        return n > 0 ? static_cast<std::uint64_t>(n) * (n - 1) : 0;
+    }
+
+    void incremental_fronts::assign(const objective_matrix& m, const std::vector<rank_t>& ranks)
+    {
+        k = m.objectives();
+        const auto n = m.size();
+        values.resize(n * k);
+        for (size_t j = 0; j < k; j++)
+        {
+            const auto* column = m.column(j);
+            for (size_t i = 0; i < n; i++)
+                values[i * k + j] = column[i];
+        }
+        fronts.clear();
+        for (size_t i = 0; i < n; i++)
+        {
+            const auto f = static_cast<size_t>(ranks[i] - 1);
+            if (fronts.size() <= f)
+                fronts.resize(f + 1);
+            fronts[f].push_back(static_cast<std::uint32_t>(i));
+        }
+        for (auto& front : fronts)
+            std::sort(front.begin(), front.end(), [this](std::uint32_t u, std::uint32_t v) { return lexicographically_less(u, v); });
+    }
+
+    bool incremental_fronts::dominates(std::uint32_t u, std::uint32_t v) const
+    {
+        const auto* a = point(u);
+        const auto* b = point(v);
+        bool strictly = false;
+        for (size_t j = 0; j < k; j++)
+        {
+            if (a[j] > b[j])
+                return false;
+            strictly |= a[j] < b[j];
+        }
+        return strictly;
+    }
+
+    bool incremental_fronts::lexicographically_less(std::uint32_t u, std::uint32_t v) const
+    {
+        const auto* a = point(u);
+        const auto* b = point(v);
+        return std::lexicographical_compare(a, a + k, b, b + k);
+    }
+
+    std::vector<std::uint32_t>::iterator incremental_fronts::position(std::vector<std::uint32_t>& front, std::uint32_t id) const
+    {
+        return std::upper_bound(front.begin(), front.end(), id, [this](std::uint32_t u, std::uint32_t v) { return lexicographically_less(u, v); });
+    }
+
+    std::uint64_t incremental_fronts::insert(const double* point_values, std::vector<rank_t>& ranks)
+    {
+        checks = 0;
+        const auto id = static_cast<std::uint32_t>(size());
+        values.insert(values.end(), point_values, point_values + k);
+        ranks.push_back(0);
+
+        // the first front with no member dominating the point
+        size_t low = 0;
+        size_t high = fronts.size();
+        while (low < high)
+        {
+            const auto mid = (low + high) / 2;
+            auto& front = fronts[mid];
+            const auto end = position(front, id);
+            bool dominated = false;
+            for (auto it = front.begin(); it != end && !dominated; ++it)
+            {
+                checks++;
+                dominated = dominates(*it, id);
+            }
+            if (dominated)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        // the point joins its front, what it dominates there moves down a front and pushes down whatever that dominates in turn
+        moving.assign(1, id);
+        for (size_t f = low; !moving.empty(); f++)
+        {
+            if (f == fronts.size())
+                fronts.emplace_back();
+            auto& front = fronts[f];
+            moved.clear();
+            std::erase_if(front, [this](std::uint32_t v) {
+                for (auto u : moving)
+                {
+                    checks++;
+                    if (dominates(u, v))
+                    {
+                        moved.push_back(v);
+                        return true;
+                    }
+                }
+                return false;
+            });
+            for (auto u : moving)
+            {
+                front.insert(position(front, u), u);
+                ranks[u] = static_cast<rank_t>(f + 1);
+            }
+            std::swap(moving, moved);
+        }
+        return checks;
+    }
+
+    void incremental_fronts::remove(std::uint32_t id, std::vector<rank_t>& ranks)
+    {
+        auto& last = fronts.back();
+        last.erase(std::find(last.begin(), last.end(), id));
+        const auto back = static_cast<std::uint32_t>(size() - 1);
+        if (id != back)
+        {
+            // the highest id takes over the removed one, its place in its front does not change since the values move with it
+            auto& front = fronts[ranks[back] - 1];
+            *std::find(front.begin(), front.end(), back) = id;
+            std::copy(point(back), point(back) + k, values.begin() + static_cast<long>(static_cast<size_t>(id) * k));
+            ranks[id] = ranks[back];
+        }
+        values.resize(values.size() - k);
+        ranks.pop_back();
+        if (last.empty())
+            fronts.pop_back();
+    }
+
+}
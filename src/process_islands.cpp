@@ -0,0 +1,367 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <process_islands.h>
+#include <blt/std/logging.h>
+#include <blt/std/format.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ga
+{
+    /**
+     * One mapping shared by the launcher and every worker. Per island: a bounded multi producer ring (the same sequence numbered cells
+     * as mpmc_queue) holding serialised migrants, and two archive snapshots the island alternates between so the one last published is
+     * always whole, even if the worker dies halfway through writing the other.
+     */
+    struct process_islands::shared_region
+    {
+        static constexpr size_t SLOT_BYTES = 4096;
+        static constexpr size_t MAX_FRONT = 128;
+        static constexpr size_t CACHE_LINE = 64;
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared memory queues need lock-free atomics");
+
+        struct slot
+        {
+            std::atomic<std::uint64_t> sequence;
+            std::uint32_t size;
+            char data[SLOT_BYTES];
+        };
+
+        struct snapshot
+        {
+            std::uint64_t generations;
+            std::uint64_t sent;
+            std::uint64_t received;
+            std::uint64_t dropped;
+            std::uint32_t points;
+            double values[MAX_FRONT * 2];
+        };
+
+        struct island
+        {
+            alignas(CACHE_LINE) std::atomic<std::uint64_t> tail;
+            alignas(CACHE_LINE) std::atomic<std::uint64_t> head;
+            alignas(CACHE_LINE) std::atomic<std::uint32_t> published;
+            snapshot snapshots[2];
+        };
+
+        void* base = MAP_FAILED;
+        size_t bytes = 0;
+        size_t islands = 0;
+        size_t slots = 0;
+
+        shared_region(size_t islands, size_t capacity): islands(islands)
+        {
+            slots = 2;
+            while (slots < capacity)
+                slots <<= 1;
+            bytes = islands * (sizeof(island) + slots * sizeof(slot));
+            // the name is only needed long enough to map it, the mapping is inherited by the workers and goes away with the last of them
+            const auto name = "/vrptw_islands_" + std::to_string(::getpid());
+            const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0)
+            {
+                BLT_ERROR("Could not create shared memory %s: %s", name.c_str(), std::strerror(errno));
+                return;
+            }
+            ::shm_unlink(name.c_str());
+            if (::ftruncate(fd, static_cast<off_t>(bytes)) == 0)
+                base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED)
+            {
+                BLT_ERROR("Could not map %lu bytes of shared memory: %s", static_cast<unsigned long>(bytes), std::strerror(errno));
+                return;
+            }
+            std::memset(base, 0, bytes);
+            for (size_t i = 0; i < islands; i++)
+            {
+                new(&get(i)) island;
+                for (size_t s = 0; s < slots; s++)
+                    new(&cell(i, s).sequence) std::atomic<std::uint64_t>(s);
+            }
+        }
+
+        ~shared_region()
+        {
+            if (base != MAP_FAILED)
+                ::munmap(base, bytes);
+        }
+
+        shared_region(const shared_region&) = delete;
+
+        shared_region& operator=(const shared_region&) = delete;
+
+        [[nodiscard]] bool ok() const
+        {
+            return base != MAP_FAILED;
+        }
+
+        island& get(size_t i)
+        {
+            return *reinterpret_cast<island*>(static_cast<char*>(base) + i * sizeof(island));
+        }
+
+        slot& cell(size_t i, size_t s)
+        {
+            return *reinterpret_cast<slot*>(static_cast<char*>(base) + islands * sizeof(island) + (i * slots + s) * sizeof(slot));
+        }
+
+        // false if the ring is full or the migrant does not fit a slot
+        bool push(size_t to, const std::string& migrant)
+        {
+            if (migrant.size() > SLOT_BYTES)
+                return false;
+            auto& isl = get(to);
+            auto pos = isl.tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                auto& c = cell(to, pos & (slots - 1));
+                const auto diff = static_cast<std::int64_t>(c.sequence.load(std::memory_order_acquire)) - static_cast<std::int64_t>(pos);
+                if (diff == 0)
+                {
+                    if (isl.tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        c.size = static_cast<std::uint32_t>(migrant.size());
+                        std::memcpy(c.data, migrant.data(), migrant.size());
+                        c.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0)
+                    return false;
+                else
+                    pos = isl.tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        // false if the ring is empty. A worker that died between claiming a cell and filling it stalls the ring there, its owner then
+        // receives nothing more but keeps running
+        bool pop(size_t i, std::string& migrant)
+        {
+            auto& isl = get(i);
+            auto pos = isl.head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                auto& c = cell(i, pos & (slots - 1));
+                const auto diff = static_cast<std::int64_t>(c.sequence.load(std::memory_order_acquire)) - static_cast<std::int64_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (isl.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        migrant.assign(c.data, c.size);
+                        c.sequence.store(pos + slots, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0)
+                    return false;
+                else
+                    pos = isl.head.load(std::memory_order_relaxed);
+            }
+        }
+
+        void publish(size_t i, const program& p, std::uint64_t sent, std::uint64_t received, std::uint64_t dropped)
+        {
+            auto& isl = get(i);
+            const auto next = 1 - isl.published.load(std::memory_order_relaxed);
+            auto& snap = isl.snapshots[next];
+            const auto& points = p.getArchive().points();
+            snap.generations = p.steps();
+            snap.sent = sent;
+            snap.received = received;
+            snap.dropped = dropped;
+            snap.points = static_cast<std::uint32_t>(std::min(points.size(), MAX_FRONT));
+            for (size_t j = 0; j < snap.points; j++)
+            {
+                snap.values[j * 2] = points[j].first;
+                snap.values[j * 2 + 1] = points[j].second;
+            }
+            isl.published.store(next, std::memory_order_release);
+        }
+    };
+
+    process_islands::process_islands(program& home, island_options options): home(home), options(options)
+    {
+        this->options.islands = std::max<size_t>(this->options.islands, 1);
+    }
+
+    bool process_islands::run(std::uint64_t generations)
+    {
+        const auto n = options.islands;
+        shared_region region(n, std::max<size_t>(options.migrants * n, 2));
+        if (!region.ok())
+            return false;
+
+        workers.assign(n, {});
+        // anything buffered would be written again by every worker
+        std::cout.flush();
+        std::cerr.flush();
+        bool forked = true;
+        for (size_t i = 0; i < n && forked; i++)
+        {
+            const pid_t pid = ::fork();
+            if (pid == 0)
+                run_worker(region, i, generations);
+            workers[i].pid = pid;
+            if (pid < 0)
+            {
+                BLT_ERROR("Could not fork island %lu: %s", static_cast<unsigned long>(i), std::strerror(errno));
+                // the islands already running are reaped below
+                for (size_t j = 0; j < i; j++)
+                    ::kill(workers[j].pid, SIGTERM);
+                forked = false;
+            }
+        }
+
+        bool any_finished = false;
+        for (size_t i = 0; i < n; i++)
+        {
+            auto& worker = workers[i];
+            if (worker.pid < 0)
+                continue;
+            int status = 0;
+            while (::waitpid(worker.pid, &status, 0) < 0 && errno == EINTR);
+            if (WIFEXITED(status))
+                worker.exit_code = WEXITSTATUS(status);
+            else if (WIFSIGNALED(status))
+                worker.signal = WTERMSIG(status);
+            worker.finished = WIFEXITED(status) && worker.exit_code == 0;
+            any_finished |= worker.finished;
+
+            const auto& isl = region.get(i);
+            const auto& snap = isl.snapshots[isl.published.load(std::memory_order_acquire)];
+            worker.generations = snap.generations;
+            worker.sent = snap.sent;
+            worker.received = snap.received;
+            worker.dropped = snap.dropped;
+            for (size_t j = 0; j < snap.points; j++)
+            {
+                worker.front.emplace_back(snap.values[j * 2], snap.values[j * 2 + 1]);
+                archive.insert(snap.values[j * 2], snap.values[j * 2 + 1]);
+            }
+            if (!worker.finished)
+            {
+                BLT_WARN("Island %lu (pid %d) died after %lu generations (%s %d), merging the front it last published",
+                         static_cast<unsigned long>(i), worker.pid, static_cast<unsigned long>(worker.generations),
+                         worker.signal != 0 ? "signal" : "exit code", worker.signal != 0 ? worker.signal : worker.exit_code);
+            }
+        }
+        return forked && any_finished;
+    }
+
+    void process_islands::run_worker(shared_region& region, size_t i, std::uint64_t generations)
+    {
+        int code = 0;
+        try
+        {
+            auto island = home.spawn_island(island_seed(home.SEED, i));
+            const auto n = options.islands;
+            std::uint64_t sent = 0, received = 0, dropped = 0;
+            std::string bytes;
+            for (std::uint64_t g = 0; g < generations && !island->finished(); g++)
+            {
+                island->executeStep();
+                if (options.interval > 0 && n > 1 && island->steps() % options.interval == 0)
+                {
+                    const auto to = migration_target(options.topology, i, n, island->engine);
+                    for (const auto& migrant : island->emigrants(options.migrants))
+                    {
+                        std::ostringstream out;
+                        write_individual(out, migrant);
+                        if (region.push(to, out.str()))
+                            sent++;
+                        else
+                            dropped++;
+                    }
+                    std::vector<individual> arrived;
+                    while (region.pop(i, bytes))
+                    {
+                        std::istringstream in(bytes);
+                        individual migrant;
+                        if (read_individual(in, migrant))
+                            arrived.push_back(std::move(migrant));
+                    }
+                    received += arrived.size();
+                    island->accept_migrants(arrived);
+                }
+                region.publish(i, *island, sent, received, dropped);
+            }
+        } catch (const std::exception& e)
+        {
+            BLT_ERROR("Island %lu failed: %s", static_cast<unsigned long>(i), e.what());
+            code = 1;
+        }
+        std::cout.flush();
+        // the launcher's destructors and exit handlers belong to the launcher
+        std::_Exit(code);
+    }
+
+    double process_islands::getHypervolume() const
+    {
+        return archive.hypervolume(home.instance->reference_vehicles, home.instance->reference_distance);
+    }
+
+    std::vector<std::string> process_islands::createTable() const
+    {
+        blt::string::TableFormatter formatter{"Island Processes (" + std::string(to_string(options.topology)) + ", " +
+                                              std::to_string(options.migrants) + " migrants every " + std::to_string(options.interval) +
+                                              " generations)"};
+        formatter.addColumn({"Island"});
+        formatter.addColumn({"Pid"});
+        formatter.addColumn({"Status"});
+        formatter.addColumn({"Generations"});
+        formatter.addColumn({"Fewest Vehicles"});
+        formatter.addColumn({"Shortest Distance"});
+        formatter.addColumn({"Archive"});
+        formatter.addColumn({"Sent/Received/Dropped"});
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            const auto& w = workers[i];
+            std::string status = "finished";
+            if (w.pid < 0)
+                status = "not started";
+            else if (w.signal != 0)
+                status = "signal " + std::to_string(w.signal);
+            else if (w.exit_code != 0)
+                status = "exit " + std::to_string(w.exit_code);
+            formatter.addRow({std::to_string(i), std::to_string(w.pid), status, std::to_string(w.generations),
+                              w.front.empty() ? "-" : std::to_string(static_cast<int>(w.front.front().first)),
+                              w.front.empty() ? "-" : std::to_string(w.front.back().second), std::to_string(w.front.size()),
+                              std::to_string(w.sent) + "/" + std::to_string(w.received) + "/" + std::to_string(w.dropped)});
+        }
+        const auto& points = archive.points();
+        formatter.addRow({"merged", "-", "-", "-", points.empty() ? "-" : std::to_string(static_cast<int>(points.front().first)),
+                          points.empty() ? "-" : std::to_string(points.back().second), std::to_string(points.size()), "-"});
+        return formatter.createTable(true, true);
+    }
+
+    bool process_islands::writeFront(const std::string& path) const
+    {
+        std::ofstream out(path);
+        if (!out)
+        {
+            BLT_ERROR("Could not open %s", path.c_str());
+            return false;
+        }
+        out << std::setprecision(std::numeric_limits<double>::max_digits10) << "vehicles,distance\n";
+        for (const auto& [vehicles, distance] : archive.points())
+            out << vehicles << ',' << distance << '\n';
+        return static_cast<bool>(out);
+    }
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <profiling.h>
+#include <blt/std/format.h>
+
+namespace ga
+{
+
+    std::uint64_t phase_profile::total() const
+    {
+        std::uint64_t t = 0;
+        for (const auto& p : phases)
+            t += p.total_ns;
+        return t;
+    }
+
+    std::vector<std::string> phase_profile::createTable(const std::string& name) const
+    {
+        blt::string::TableFormatter formatter{name};
+        formatter.addColumn({"Phase"});
+        formatter.addColumn({"Samples"});
+        formatter.addColumn({"Total (ms)"});
+        formatter.addColumn({"Avg (us)"});
+        formatter.addColumn({"Min (us)"});
+        formatter.addColumn({"Max (us)"});
+        formatter.addColumn({"Share (%)"});
+
+        auto sum = static_cast<double>(total());
+        for (size_t i = 0; i < phases.size(); i++)
+        {
+            const auto& p = phases[i];
+            if (p.samples == 0)
+                continue;
+            formatter.addRow({PHASE_NAMES[i],
+                              std::to_string(p.samples),
+                              std::to_string(static_cast<double>(p.total_ns) / 1e6),
+                              std::to_string(p.average() / 1e3),
+                              std::to_string(static_cast<double>(p.min_ns) / 1e3),
+                              std::to_string(static_cast<double>(p.max_ns) / 1e3),
+                              std::to_string(sum == 0 ? 0 : static_cast<double>(p.total_ns) / sum * 100)});
+        }
+        return formatter.createTable(true, true);
+    }
+
+    void phase_profile::writeCSVHeader(std::ostream& out)
+    {
+        out << "Label,Phase,Samples,Total_ns,Avg_ns,Min_ns,Max_ns\n";
+    }
+
+    void phase_profile::writeCSV(std::ostream& out, const std::string& label) const
+    {
+        for (size_t i = 0; i < phases.size(); i++)
+        {
+            const auto& p = phases[i];
+            if (p.samples == 0)
+                continue;
+            out << label << ',' << PHASE_NAMES[i] << ',' << p.samples << ',' << p.total_ns << ',' << p.average() << ',' << p.min_ns << ','
+                << p.max_ns << '\n';
+        }
+    }
+
+}
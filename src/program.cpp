@@ -4,6 +4,7 @@
  * See LICENSE file for license detail
  */
 #include <program.h>
+#include <hash.h>
 
 #include <blt/std/logging.h>
 #include <valarray>
@@ -22,48 +23,180 @@ namespace ga
 #define HARD_VRPTW(lastDepartTime, route) (lastDepartTime)
     
     
+    problem_instance::problem_instance(std::int32_t capacity, std::vector<record>&& records): capacity(capacity), records(std::move(records))
+    {
+        const auto n = this->records.size();
+        distances.resize(n * n);
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                const auto& customer1 = this->records[i];
+                const auto& customer2 = this->records[j];
+                auto x = customer1.x - customer2.x;
+                auto y = customer1.y - customer2.y;
+                distances[i * n + j] = std::sqrt(x * x + y * y);
+            }
+        }
+        // one past every customer alone on a route, out from the depot and back. records[0] is the depot, so there are n - 1 customers
+        reference_vehicles = static_cast<double>(n);
+        for (size_t i = 1; i < n; i++)
+            reference_distance += 2 * distances[i];
+        reference_distance += 1;
+    }
+    
+    std::string_view to_string(objective_mode mode)
+    {
+        switch (mode)
+        {
+            case objective_mode::PARETO:
+                return "pareto";
+            case objective_mode::WEIGHTED_SUM:
+                return "weighted_sum";
+            case objective_mode::LEXICOGRAPHIC:
+                return "lexicographic";
+        }
+        return "unknown";
+    }
+    
+    std::string_view to_string(stop_reason reason)
+    {
+        switch (reason)
+        {
+            case stop_reason::NONE:
+                return "running";
+            case stop_reason::GENERATIONS:
+                return "generations";
+            case stop_reason::STAGNATION:
+                return "stagnation";
+            case stop_reason::TIME:
+                return "time";
+            case stop_reason::EVALUATIONS:
+                return "evaluations";
+        }
+        return "unknown";
+    }
+    
+    std::string_view to_string(step_mode mode)
+    {
+        switch (mode)
+        {
+            case step_mode::GENERATIONAL:
+                return "generational";
+            case step_mode::STEADY_STATE:
+                return "steady_state";
+        }
+        return "unknown";
+    }
+    
+    bool parse_step_mode(std::string_view str, step_mode& mode)
+    {
+        for (auto m : {step_mode::GENERATIONAL, step_mode::STEADY_STATE})
+        {
+            if (str == to_string(m))
+            {
+                mode = m;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool parse_objective(std::string_view str, objective_mode& mode)
+    {
+        for (auto m : {objective_mode::PARETO, objective_mode::WEIGHTED_SUM, objective_mode::LEXICOGRAPHIC})
+        {
+            if (str == to_string(m))
+            {
+                mode = m;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    program::program(const program& twin, objective_mode mode):
+            instance(twin.instance), capacity(twin.capacity), records(instance->records), current_population(twin.current_population),
+            engine(twin.engine), POPULATION_SIZE(twin.POPULATION_SIZE), GENERATION_COUNT(twin.GENERATION_COUNT),
+            TOURNAMENT_SIZE(twin.TOURNAMENT_SIZE), ELITE_COUNT(twin.ELITE_COUNT), CROSSOVER_RATE(twin.CROSSOVER_RATE),
+            MUTATION_RATE(twin.MUTATION_RATE), MUTATION2_RATE(twin.MUTATION2_RATE), SEED(twin.SEED), objective(mode),
+            pareto_objectives(twin.pareto_objectives)
+    {
+        BLT_ASSERT(twin.count == 0 && "Only a program that has not run yet can have a twin");
+        generation_data = history_store(twin.generation_data.config(), POPULATION_SIZE);
+        termination = twin.termination;
+        clone_immigrants = twin.clone_immigrants;
+        stepping = twin.stepping;
+    }
+    
+    program::program(const program& master, std::uint64_t seed):
+            instance(master.instance), capacity(master.capacity), records(instance->records), current_population(master.current_population),
+            engine(seed), POPULATION_SIZE(master.POPULATION_SIZE), GENERATION_COUNT(master.GENERATION_COUNT),
+            TOURNAMENT_SIZE(master.TOURNAMENT_SIZE), ELITE_COUNT(master.ELITE_COUNT), CROSSOVER_RATE(master.CROSSOVER_RATE),
+            MUTATION_RATE(master.MUTATION_RATE), MUTATION2_RATE(master.MUTATION2_RATE), SEED(seed), objective(master.objective),
+            pareto_objectives(master.pareto_objectives)
+    {
+        stepping = step_mode::STEADY_STATE;
+    }
+    
     double program::distance(customerID_t c1, customerID_t c2)
     {
-        const auto& customer1 = records[c1];
-        const auto& customer2 = records[c2];
-        auto x = customer1.x - customer2.x;
-        auto y = customer1.y - customer2.y;
-        return std::sqrt(x * x + y * y);
+        return instance->distance(c1, c2);
     }
     
     double program::calculate_distance(const route& r)
+    {
+        return calculate_distance(std::span<const customerID_t>(r.customers));
+    }
+    
+    double program::calculate_distance(std::span<const customerID_t> customers)
     {
         // distance between first customer and the depot
-        double dist = distance(0, r.customers[0]);
-        for (size_t i = 1; i < r.customers.size(); i++)
+        double dist = distance(0, customers[0]);
+        for (size_t i = 1; i < customers.size(); i++)
         {
-            dist += distance(r.customers[i - 1], r.customers[i]);
+            dist += distance(customers[i - 1], customers[i]);
         }
         // distance between last customer and the depot
-        dist += distance(r.customers[r.customers.size() - 1], 0);
+        dist += distance(customers[customers.size() - 1], 0);
         return dist;
     }
     
     bool program::validate_route(const route& r)
     {
+        return validate_route(std::span<const customerID_t>(r.customers));
+    }
+    
+    bool program::validate_route(std::span<const customerID_t> customers)
+    {
+        GA_COUNT(counters, VALIDATIONS);
         // by returning max we will never use this solution. it also remains possible to check for error
-        if (r.customers.empty())
+        if (customers.empty())
             return false;
         const double dueTime = records[0].due;
         double used_capacity = 0;
         double arrivalTime = 0;
-        for (const auto& v : r.customers)
+        for (const auto& v : customers)
         {
             const auto& record = records[v];
             // capacity constraints
             if (used_capacity + record.demand > capacity)
+            {
+                GA_COUNT(counters, REJECT_CAPACITY);
                 return false;
+            }
             // arrival constraints
             if (arrivalTime > record.due)
+            {
+                GA_COUNT(counters, REJECT_ARRIVAL);
                 return false;
+            }
             // return time constraints
             if (arrivalTime + record.service_time > dueTime)
+            {
+                GA_COUNT(counters, REJECT_RETURN);
                 return false;
+            }
             used_capacity += record.demand;
             // handle early arrival time by making it wait.
             arrivalTime = std::max(arrivalTime, record.ready) + record.service_time;
@@ -73,29 +206,49 @@ namespace ga
         return true;
     }
     
-    /**
-     * u dominates v iff ∀i ∈ (1, ..., k) : ui ≤ vi ∧ ∃i ∈ (1, ..., k) : ui < vi
-     * @return if u is dominated by v
-     */
-    bool program::dominates(const individual& u, const individual& v)
+    double program::route_duration(const route& r, double& waiting)
     {
-        auto u_distance = u.total_routes_distance;
-        auto v_distance = v.total_routes_distance;
-        auto u_vehicles = u.routes.size();
-        auto v_vehicles = v.routes.size();
-        // ∀i ∈ (1, ..., k) : ui ≤ v   ^   ∃i ∈ (1, ..., k) : ui < vi
-        return (u_distance <= v_distance && u_vehicles <= v_vehicles) && (u_distance < v_distance || u_vehicles < v_vehicles);
+        // same clock as validate_route, travel takes no time and arriving early waits for the window to open
+        double time = 0;
+        for (const auto& v : r.customers)
+        {
+            const auto& record = records[v];
+            waiting += std::max(0.0, record.ready - time);
+            time = std::max(time, record.ready) + record.service_time;
+        }
+        return time;
     }
     
-    bool program::is_non_dominated(customerID_t v)
+    double program::objective_value(const individual& i, objective_id id)
     {
-        for (customerID_t i = 0; i < static_cast<customerID_t>(current_population.pops.size()); i++)
+        switch (id)
         {
-            // if v is dominated by some pop i, then v cannot be non-dominated
-            if (v != i && dominates(current_population.pops[i], current_population.pops[v]))
-                return false;
+            case objective_id::VEHICLES:
+                return static_cast<double>(i.routes.size());
+            case objective_id::DISTANCE:
+                return i.total_routes_distance;
+            case objective_id::WAITING:
+            {
+                double waiting = 0;
+                for (const auto& r : i.routes)
+                    route_duration(r, waiting);
+                return waiting;
+            }
+            case objective_id::IMBALANCE:
+            {
+                double waiting = 0;
+                double shortest = std::numeric_limits<double>::max();
+                double longest = 0;
+                for (const auto& r : i.routes)
+                {
+                    auto duration = route_duration(r, waiting);
+                    shortest = std::min(shortest, duration);
+                    longest = std::max(longest, duration);
+                }
+                return i.routes.empty() ? 0 : longest - shortest;
+            }
         }
-        return true;
+        return 0;
     }
     
     fitness_t program::weighted_sum_fitness(individual& v)
@@ -103,11 +256,12 @@ namespace ga
         return ALPHA * static_cast<fitness_t>(v.routes.size()) + BETA * v.total_routes_distance;
     }
     
+    template<typename Objective>
     customerID_t program::select_pop(size_t tournament_size)
     {
         
         //  A set of K individuals are randomly selected from the population
-        std::vector<customerID_t> buffer;
+        std::pmr::vector<customerID_t> buffer(scratch->resource());
         buffer.reserve(tournament_size);
         while (buffer.size() < tournament_size)
         {
@@ -119,30 +273,10 @@ namespace ga
         if (engine.getDouble(0, 1) < 0.8)
         {
             size_t index = 0;
-            if (using_fitness)
-            {
-                fitness_t min_fitness = std::numeric_limits<fitness_t>::max();
-                for (size_t i = 0; i < buffer.size(); i++)
-                {
-                    auto f = current_population.pops[buffer[i]].fitness;
-                    if (f < min_fitness)
-                    {
-                        min_fitness = f;
-                        index = i;
-                    }
-                }
-            } else
+            for (size_t i = 1; i < buffer.size(); i++)
             {
-                rank_t min_rank = std::numeric_limits<rank_t>::max();
-                for (size_t i = 0; i < buffer.size(); i++)
-                {
-                    auto r = current_population.pops[buffer[i]].rank;
-                    if (r < min_rank)
-                    {
-                        min_rank = r;
-                        index = i;
-                    }
-                }
+                if (Objective::better(current_population.pops[buffer[i]], current_population.pops[buffer[index]]))
+                    index = i;
             }
             return buffer[index];
         } else
@@ -165,26 +299,30 @@ namespace ga
     
     void program::insert_to(const route& r_in, individual& c_in)
     {
+        // cache the route distance
+        struct route_cache
+        {
+            double distance = 0;
+            size_t route_index = 0;
+            size_t insertion_index = 0;
+        };
+        
+        // every trial reuses the same scratch buffers rather than copying the route
+        std::pmr::vector<route_cache> possibleRoutes(scratch->resource());
+        std::pmr::vector<customerID_t> trial(scratch->resource());
         for (std::int32_t v : r_in.customers)
         {
-            // cache the route distance
-            struct route_cache
-            {
-                double distance = 0;
-                size_t route_index = 0;
-                size_t insertion_index = 0;
-            };
-            
-            std::vector<route_cache> possibleRoutes;
+            possibleRoutes.clear();
             for (size_t j = 0; j < c_in.routes.size(); j++)
             {
                 const route& r = c_in.routes[j];
                 for (size_t i = 0; i < r.customers.size(); i++)
                 {
-                    route r_copy = r;
-                    r_copy.customers.insert(r_copy.customers.begin() + static_cast<long>(i), v);
-                    if (validate_route(r_copy))
-                        possibleRoutes.emplace_back(calculate_distance(r_copy), j, i);
+                    GA_COUNT(counters, INSERTIONS_TRIED);
+                    trial.assign(r.customers.begin(), r.customers.end());
+                    trial.insert(trial.begin() + static_cast<long>(i), v);
+                    if (validate_route(trial))
+                        possibleRoutes.emplace_back(calculate_distance(trial), j, i);
                 }
             }
             // no feasible route found, we must make a new one
@@ -208,16 +346,66 @@ namespace ga
         }
     }
     
+    static std::uint64_t hash_chromosome(const chromosome& c)
+    {
+        return fnv1a(c.genes.data(), sizeof(customerID_t) * c.genes.size());
+    }
+    
+    static bool same_genes(const individual& a, const individual& b)
+    {
+        return a.hash == b.hash && std::memcmp(a.c.genes.data(), b.c.genes.data(), sizeof(customerID_t) * a.c.genes.size()) == 0;
+    }
+    
     void program::reconstruct_populations()
     {
+        // decoding is deterministic, a chromosome decoded before gets the same routes again. Ranking reorders the population so the
+        // last generation is indexed again rather than kept from its decode
+        previous_decoded.clear();
+        for (const auto& c : previous_population.pops)
+            previous_decoded.emplace(c.hash, &c);
+        decoded.clear();
         for (auto& c : current_population.pops)
         {
             c.rank = 0;
             c.fitness = 0;
             c.total_routes_distance = 0;
-            c.routes = constructRoute(c.c);
-            for (const auto& r : c.routes)
-                c.total_routes_distance += r.total_distance;
+            if (c.hash == 0)
+                c.hash = hash_chromosome(c.c);
+            
+            const individual* source = nullptr;
+            auto found = decoded.find(c.hash);
+            if (found != decoded.end() && same_genes(*found->second, c))
+            {
+                if (clone_immigrants)
+                {
+                    immigrant_count++;
+                    c.c = createRandomChromosome();
+                    c.hash = hash_chromosome(c.c);
+                    found = decoded.find(c.hash);
+                    if (found != decoded.end() && same_genes(*found->second, c))
+                        source = found->second;
+                } else
+                    source = found->second;
+            }
+            if (!source)
+            {
+                auto previous = previous_decoded.find(c.hash);
+                if (previous != previous_decoded.end() && same_genes(*previous->second, c))
+                    source = previous->second;
+            }
+            
+            if (source)
+            {
+                clone_count++;
+                c.routes = source->routes;
+                c.total_routes_distance = source->total_routes_distance;
+            } else
+            {
+                c.routes = constructRoute(c.c);
+                for (const auto& r : c.routes)
+                    c.total_routes_distance += r.total_distance;
+            }
+            decoded.emplace(c.hash, &c);
         }
     }
     
@@ -230,37 +418,70 @@ namespace ga
     
     void program::add_step_to_history()
     {
-        generation_point gen_point{count};
+        const bool sampled = generation_data.begin(count);
+        if (history_stream)
+            history_stream->begin(count);
+        last_front.clear();
+        front_points.clear();
+        bool improved = false;
+        bool archive_changed = false;
         double best_distAvg = 0;
         double avg_distAvg = 0;
         size_t best_routes = 0;
         size_t avg_routes = 0;
         size_t cnt = 0;
         size_t best_cnt = 0;
-        fitness_t fit = std::numeric_limits<double>::max();
-        for (const auto& i : current_population.pops)
-            fit = std::min(fit, i.fitness);
         for (int i = 0; i < POPULATION_SIZE; i++)
         {
             auto& currentP = current_population.pops[i];
-            gen_point.indv.push_back(individual_point{currentP.total_routes_distance, currentP.fitness, currentP.rank, currentP.routes.size()});
+            individual_point point{currentP.total_routes_distance, currentP.fitness, currentP.rank, currentP.routes.size()};
+            if (sampled)
+                generation_data.push(point);
+            if (history_stream)
+                history_stream->push(point);
+            if (point.rank == 1)
+                last_front.push_back(point);
+            // the whole population, whatever it was ranked on the (vehicles, distance) front is what the hypervolume measures
+            front_points.emplace_back(static_cast<double>(point.routes), point.distance);
+            if (point.distance < best_distance.distance)
+                best_distance = point;
+            if (point.routes < best_cars.routes || (point.routes == best_cars.routes && point.distance < best_cars.distance))
+                best_cars = point;
+            if (point.fitness < best_fitness.fitness)
+            {
+                best_fitness = point;
+                improved = true;
+            }
+            archive_changed |= archive.insert(static_cast<double>(point.routes), point.distance);
             auto total_dist = currentP.total_routes_distance;
             auto total_routes = currentP.routes.size();
             avg_distAvg += total_dist;
             avg_routes += total_routes;
             cnt++;
-            auto lf = currentP.fitness;
-            if (using_fitness && !(lf >= fit - EPSILON && lf <= fit + EPSILON))
-                continue;
-            if (!using_fitness && currentP.rank != 1)
+            // rank 1 is the front, or the individuals tied with the best under a total order
+            if (currentP.rank != 1)
                 continue;
             best_distAvg += total_dist;
             best_routes += total_routes;
             best_cnt++;
         }
         best_history.push_back({best_distAvg / static_cast<double>(best_cnt), best_routes / best_cnt, count});
+        hypervolume_history.push_back(hypervolume_2d(front_points, instance->reference_vehicles, instance->reference_distance));
+        if (archive_changed)
+        {
+            const auto& points = archive.points();
+            // this generation's evaluations are done, count is only advanced at the end of the step
+            anytime_trace.push_back({stepping_seconds(), static_cast<std::uint64_t>(count + 1) * static_cast<std::uint64_t>(POPULATION_SIZE),
+                                     points.front().first, points.front().second, points.back().second,
+                                     archive.hypervolume(instance->reference_vehicles, instance->reference_distance)});
+        }
+        if (improved || archive_changed)
+            last_improvement = count + 1;
         avg_history.push_back({avg_distAvg / static_cast<double>(cnt), avg_routes / cnt, count});
-	generation_data.push_back(gen_point);
+        if (sampled)
+            generation_data.end();
+        if (history_stream)
+            history_stream->end();
     }
     
     void program::reconstruct_chromosome(individual& i)
@@ -272,15 +493,25 @@ namespace ga
                 BLT_ERROR("failure of setting");
         }
         int insertion_index = 0;
+        // the hash is built up as the genes are written, the same bytes in the same order as hash_chromosome
+        std::uint64_t hash = FNV_OFFSET;
         for (const auto& route : i.routes)
         {
             for (const auto& customer : route.customers)
+            {
                 i.c.genes[insertion_index++] = customer;
+                hash = fnv1a(&customer, sizeof(customer), hash);
+            }
         }
+        // any genes left unset are zero
+        for (int j = insertion_index; j < CUSTOMER_COUNT; j++)
+            hash = fnv1a(&i.c.genes[j], sizeof(customerID_t), hash);
+        i.hash = hash;
     }
     
     std::vector<route> program::constructRoute(const chromosome& c)
     {
+        GA_COUNT(counters, DECODES);
         std::vector<route> routes;
         
         const double dueTime = records[0].due;
@@ -322,13 +553,13 @@ namespace ga
             routes.push_back(currentRoute);
         }
         
-        // phase 2
+        // phase 2, the moved route is tried in a scratch buffer and only copied back if it is kept
+        std::pmr::vector<customerID_t> rc1(scratch->resource());
         for (size_t i = 1; i < routes.size(); i++)
         {
             auto& route1 = routes[i - 1];
-            auto rc1 = routes[i - 1];
+            rc1.assign(route1.customers.begin(), route1.customers.end());
             auto& route2 = routes[i];
-            auto rc2 = routes[i];
             
 //            auto back = rc1.customers.back();
 //            auto front = rc2.customers.front();
@@ -338,22 +569,23 @@ namespace ga
 //
 //            rc1.customers.push_back(front);
 //            rc2.customers.push_back(back);
-            std::swap(rc1.customers.back(), rc1.customers.front());
+            std::swap(rc1.back(), rc1.front());
             
             // if they are not valid, skip
-            if (!validate_route(rc1) || !validate_route(rc2))
+            if (!validate_route(rc1) || !validate_route(route2))
                 continue;
             
-            rc1.total_distance = calculate_distance(rc1);
-            rc2.total_distance = calculate_distance(rc2);
+            const auto rc1_distance = calculate_distance(rc1);
+            const auto rc2_distance = calculate_distance(route2);
             
             // reject changes if not better
-            if (rc1.total_distance + rc2.total_distance >= route1.total_distance + route2.total_distance)
+            if (rc1_distance + rc2_distance >= route1.total_distance + route2.total_distance)
                 continue;
             
             // accept changes
-            route1 = rc1;
-            route2 = rc2;
+            route1.customers.assign(rc1.begin(), rc1.end());
+            route1.total_distance = rc1_distance;
+            route2.total_distance = rc2_distance;
 
             BLT_ASSERT(validate_route(route1) && validate_route(route2));
         }
@@ -365,7 +597,7 @@ namespace ga
     {
         chromosome ca{};
         
-        std::vector<std::int32_t> unused;
+        std::pmr::vector<std::int32_t> unused(scratch->resource());
         for (int i = 1; i <= CUSTOMER_COUNT; i++)
             unused.push_back(i);
         
@@ -393,7 +625,7 @@ namespace ga
                 // Add customer node ci to the chromosome string l;
                 ca.genes[insert_index++] = ci;
                 
-                std::vector<std::int32_t> close;
+                std::pmr::vector<std::int32_t> close(scratch->resource());
                 
                 // Within an empirically decided Euclidean radius centered around ci, choose the nearest customer cj , where cj 6 ∈ l
                 static constexpr double MAX_DISTANCE = 25;
@@ -422,26 +654,133 @@ namespace ga
     }
     
     void program::executeStep()
+    {
+        step_start = std::chrono::steady_clock::now();
+        with_objective([this](auto policy) {
+            if (stepping == step_mode::STEADY_STATE)
+                steady_state_step<decltype(policy)>();
+            else
+                step<decltype(policy)>();
+        });
+        stepping_ns += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - step_start).count());
+        arena_history.push_back(scratch->release());
+    }
+    
+    std::vector<individual> program::emigrants(size_t n)
+    {
+        const auto& ranked = stepping == step_mode::STEADY_STATE ? current_population : previous_population;
+        std::vector<size_t> front;
+        for (size_t i = 0; i < ranked.pops.size(); i++)
+        {
+            if (ranked.pops[i].rank == 1)
+                front.push_back(i);
+        }
+        std::vector<individual> picked;
+        for (size_t i = 0; i < n && i < front.size(); i++)
+        {
+            std::swap(front[i], front[engine.getLong(static_cast<std::uint64_t>(i), static_cast<std::uint64_t>(front.size() - 1))]);
+            picked.push_back(ranked.pops[front[i]]);
+        }
+        return picked;
+    }
+    
+    std::unique_ptr<program> program::spawn_island(std::uint64_t seed) const
+    {
+        auto island = std::make_unique<program>(instance, objective, POPULATION_SIZE, GENERATION_COUNT, TOURNAMENT_SIZE, ELITE_COUNT,
+                                                CROSSOVER_RATE, MUTATION_RATE, MUTATION2_RATE, seed);
+        island->setParetoObjectives(pareto_objectives);
+        island->setTermination(termination);
+        island->setCloneImmigrants(clone_immigrants);
+        island->setStepMode(stepping);
+        island->setHistoryPolicy(generation_data.config());
+        return island;
+    }
+    
+    void program::accept_migrants(std::vector<individual>& migrants)
+    {
+        if (stepping == step_mode::STEADY_STATE && steady_state_ready)
+        {
+            with_objective([this, &migrants](auto policy) {
+                for (auto& migrant : migrants)
+                    insert_offspring<decltype(policy)>(std::move(migrant));
+            });
+            return;
+        }
+        auto& pops = current_population.pops;
+        const auto first = std::min(static_cast<size_t>(std::max(ELITE_COUNT, 0)), pops.size() - 1);
+        for (auto& migrant : migrants)
+            pops[engine.getLong(static_cast<std::uint64_t>(first), static_cast<std::uint64_t>(pops.size() - 1))] = std::move(migrant);
+    }
+    
+    double program::stepping_seconds() const
+    {
+        return static_cast<double>(stepping_ns + static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - step_start).count())) / 1e9;
+    }
+    
+    bool program::finished()
+    {
+        const auto generations = termination.generations > 0 ? termination.generations : static_cast<std::uint64_t>(GENERATION_COUNT);
+        if (count >= generations)
+            stopped = stop_reason::GENERATIONS;
+        else if (termination.stagnation > 0 && count - last_improvement >= termination.stagnation)
+            stopped = stop_reason::STAGNATION;
+        else if (termination.time_budget > 0 && elapsed() >= termination.time_budget)
+            stopped = stop_reason::TIME;
+        else if (termination.evaluation_budget > 0 && evaluations() >= termination.evaluation_budget)
+            stopped = stop_reason::EVALUATIONS;
+        else
+            stopped = stop_reason::NONE;
+        return stopped != stop_reason::NONE;
+    }
+    
+    template<typename Objective>
+    void program::step()
     {
         // step 1. Transform each chromosome into feasible network configuration
         // by applying the routing scheme;
-        reconstruct_populations();
+        {
+            phase_timer timer(profile, phase::RECONSTRUCT);
+            reconstruct_populations();
+        }
         
-        calculatePopulationFitness();
+        {
+            phase_timer timer(profile, phase::FITNESS);
+            calculatePopulationFitness();
+        }
         // Evaluate fitness of the individuals of POP;
-        rankPopulation();
+        {
+            phase_timer timer(profile, phase::RANK);
+            rankPopulation<Objective>();
+        }
         
-        add_step_to_history();
+        {
+            phase_timer timer(profile, phase::HISTORY);
+            add_step_to_history();
+        }
         
         population new_pop;
-        keepElites(new_pop, ELITE_COUNT); // GREETINGS
+        {
+            phase_timer timer(profile, phase::ELITISM);
+            keepElites<Objective>(new_pop, ELITE_COUNT); // GREETINGS
+        }
         
-        while (static_cast<std::int32_t>(new_pop.pops.size()) < POPULATION_SIZE)
-            applyCrossover(new_pop);
+        {
+            phase_timer timer(profile, phase::CROSSOVER);
+            while (static_cast<std::int32_t>(new_pop.pops.size()) < POPULATION_SIZE)
+                applyCrossover<Objective>(new_pop);
+        }
         
-        applyMutation(new_pop);
+        {
+            phase_timer timer(profile, phase::MUTATION);
+            applyMutation(new_pop);
+        }
         
-        rebuild_population_chromosomes(new_pop);
+        {
+            phase_timer timer(profile, phase::REBUILD);
+            rebuild_population_chromosomes(new_pop);
+        }
         //reconstruct_populations();
         //rankPopulation();
         
@@ -452,38 +791,262 @@ namespace ga
         //while (new_pop.pops.size() > current_population.pops.size())
         //    new_pop.pops.pop_back();
         
-        current_population = new_pop;
+        // the outgoing population stays around so the next decode can reuse its routes
+        previous_population = std::move(current_population);
+        current_population = std::move(new_pop);
+        population_evaluated = false;
         count++;
     }
     
-    void program::rankPopulation()
+    template<typename Objective>
+    void program::steady_state_step()
     {
-        population& pop = current_population;
-        population ranked_pops;
+        prepare_steady_state<Objective>();
+        
+        {
+            phase_timer timer(profile, phase::HISTORY);
+            add_step_to_history();
+        }
+        
+        std::int32_t bred = 0;
+        while (bred < POPULATION_SIZE)
+        {
+            offspring.pops.clear();
+            breed_offspring<Objective>(offspring);
+            for (auto& child : offspring.pops)
+            {
+                replace_clone(child);
+                evaluate_unique_offspring(child);
+                {
+                    phase_timer timer(profile, phase::RANK);
+                    insert_offspring<Objective>(std::move(child));
+                }
+                bred++;
+            }
+        }
         
-        int currentRank = 1;
-        int N = POPULATION_SIZE;
-        int m = N;
-        while (N != 0)
+        finish_steady_state_generation<Objective>();
+    }
+    
+    template<typename Objective>
+    void program::prepare_steady_state()
+    {
+        if (!steady_state_ready)
         {
-            //BLT_DEBUG("Running on %d with total pops left %d new pops %d", currentRank, pop.pops.size(), ranked_pops.pops.size());
-            for (int i = 0; i < m; i++)
+            // the first step, or the first after a restore or a change of mode, starts from a population that is not ranked yet. One
+            // restored from a steady state checkpoint is decoded already, decoding it again would replace the clones it holds
+            if (!population_evaluated)
             {
-                if (is_non_dominated(i))
                 {
-                    current_population.pops[i].rank = currentRank;
-                    ranked_pops.pops.push_back(current_population.pops[i]);
-                    N--;
+                    phase_timer timer(profile, phase::RECONSTRUCT);
+                    reconstruct_populations();
                 }
+                {
+                    phase_timer timer(profile, phase::FITNESS);
+                    calculatePopulationFitness();
+                }
+                population_evaluated = true;
+            }
+            {
+                phase_timer timer(profile, phase::RANK);
+                rank_steady_state<Objective>();
+            }
+            steady_state_ready = true;
+        }
+    }
+    
+    template<typename Objective>
+    void program::breed_offspring(population& out)
+    {
+        {
+            phase_timer timer(profile, phase::CROSSOVER);
+            applyCrossover<Objective>(out);
+        }
+        {
+            phase_timer timer(profile, phase::MUTATION);
+            applyMutation(out);
+        }
+        {
+            phase_timer timer(profile, phase::REBUILD);
+            rebuild_population_chromosomes(out);
+        }
+    }
+    
+    void program::evaluate_offspring(individual& child)
+    {
+        {
+            phase_timer timer(profile, phase::RECONSTRUCT);
+            child.routes = constructRoute(child.c);
+            child.total_routes_distance = 0;
+            for (const auto& r : child.routes)
+                child.total_routes_distance += r.total_distance;
+        }
+        {
+            phase_timer timer(profile, phase::FITNESS);
+            child.fitness = weighted_sum_fitness(child);
+        }
+    }
+    
+    const individual* program::find_clone(individual& child) const
+    {
+        if (child.hash == 0)
+            child.hash = hash_chromosome(child.c);
+        // a scan of the hashes costs far less than the decode it saves, and needs no index kept in step with the insertions
+        for (const auto& member : current_population.pops)
+        {
+            if (same_genes(member, child))
+                return &member;
+        }
+        return nullptr;
+    }
+    
+    bool program::replace_clone(individual& child)
+    {
+        if (!clone_immigrants || !find_clone(child))
+            return false;
+        immigrant_count++;
+        child.c = createRandomChromosome();
+        child.hash = hash_chromosome(child.c);
+        return true;
+    }
+    
+    void program::evaluate_unique_offspring(individual& child)
+    {
+        const auto* member = find_clone(child);
+        if (!member)
+        {
+            evaluate_offspring(child);
+            return;
+        }
+        clone_count++;
+        child.routes = member->routes;
+        child.total_routes_distance = member->total_routes_distance;
+        {
+            phase_timer timer(profile, phase::FITNESS);
+            child.fitness = weighted_sum_fitness(child);
+        }
+    }
+    
+    bool program::archive_offspring(const individual& child)
+    {
+        if (!archive.insert(static_cast<double>(child.routes.size()), child.total_routes_distance))
+            return false;
+        const auto& points = archive.points();
+        anytime_trace.push_back({stepping_seconds(), static_cast<std::uint64_t>(count + 1) * static_cast<std::uint64_t>(POPULATION_SIZE),
+                                 points.front().first, points.front().second, points.back().second,
+                                 archive.hypervolume(instance->reference_vehicles, instance->reference_distance)});
+        last_improvement = count + 1;
+        return true;
+    }
+    
+    template<typename Objective>
+    void program::finish_steady_state_generation()
+    {
+        if constexpr (Objective::total_order)
+        {
+            auto& pops = current_population.pops;
+            for (auto& i : pops)
+                i.rank = Objective::tied(i, pops.front()) ? 1 : 2;
+        }
+        count++;
+    }
+    
+    template<typename Objective>
+    void program::rank_steady_state()
+    {
+        auto& pops = current_population.pops;
+        if constexpr (Objective::total_order)
+        {
+            // kept fully sorted from here on, each offspring is put in its place
+            std::stable_sort(pops.begin(), pops.end(), Objective::better);
+            for (auto& i : pops)
+                i.rank = Objective::tied(i, pops.front()) ? 1 : 2;
+        } else
+        {
+            const auto k = pareto_objectives.size();
+            objective_values.reset(k, pops.size());
+            for (size_t j = 0; j < k; j++)
+            {
+                auto* column = objective_values.column(j);
+                for (size_t i = 0; i < pops.size(); i++)
+                    column[i] = objective_value(pops[i], pareto_objectives[j]);
             }
-            // remove all with this current rank
-            std::erase_if(pop.pops, [&currentRank](const ga::individual& v) -> bool { return v.rank == currentRank; });
-            currentRank++;
-            m = N;
+            [[maybe_unused]] auto checks = sorter.sort(objective_values, ranks);
+            GA_COUNT_N(counters, DOMINANCE_CHECKS, checks);
+            fronts.assign(objective_values, ranks);
+            for (size_t i = 0; i < pops.size(); i++)
+                pops[i].rank = ranks[i];
         }
-        current_population = std::move(ranked_pops);
     }
     
+    template<typename Objective>
+    void program::insert_offspring(individual&& child)
+    {
+        auto& pops = current_population.pops;
+        if constexpr (Objective::total_order)
+        {
+            // after every member it is not better than, so an equal offspring never pushes out an incumbent
+            auto at = std::upper_bound(pops.begin(), pops.end(), child, Objective::better);
+            if (at == pops.end())
+                return;
+            pops.insert(at, std::move(child));
+            pops.pop_back();
+        } else
+        {
+            offspring_values.resize(pareto_objectives.size());
+            for (size_t j = 0; j < pareto_objectives.size(); j++)
+                offspring_values[j] = objective_value(child, pareto_objectives[j]);
+            pops.push_back(std::move(child));
+            [[maybe_unused]] auto checks = fronts.insert(offspring_values.data(), ranks);
+            GA_COUNT_N(counters, DOMINANCE_CHECKS, checks);
+            
+            // the worst of the last front by fitness, the highest id breaks ties so the choice does not depend on the front's order
+            std::uint32_t worst = fronts.last_front().front();
+            for (auto id : fronts.last_front())
+            {
+                if (pops[id].fitness > pops[worst].fitness || (pops[id].fitness == pops[worst].fitness && id > worst))
+                    worst = id;
+            }
+            fronts.remove(worst, ranks);
+            if (worst != pops.size() - 1)
+                pops[worst] = std::move(pops.back());
+            pops.pop_back();
+            for (size_t i = 0; i < pops.size(); i++)
+                pops[i].rank = ranks[i];
+        }
+    }
+    
+    template<typename Objective>
+    void program::rankPopulation()
+    {
+        if constexpr (Objective::total_order)
+        {
+            // selection only compares individuals and elitism only needs the best few, so the population is never fully sorted
+            auto& pops = current_population.pops;
+            const auto front = std::min(static_cast<size_t>(std::max(ELITE_COUNT, 1)), pops.size());
+            std::partial_sort(pops.begin(), pops.begin() + static_cast<long>(front), pops.end(), Objective::better);
+            for (auto& i : pops)
+                i.rank = Objective::tied(i, pops.front()) ? 1 : 2;
+            return;
+        }
+        auto& pops = current_population.pops;
+        const auto k = pareto_objectives.size();
+        objective_values.reset(k, pops.size());
+        for (size_t j = 0; j < k; j++)
+        {
+            auto* column = objective_values.column(j);
+            for (size_t i = 0; i < pops.size(); i++)
+                column[i] = objective_value(pops[i], pareto_objectives[j]);
+        }
+        [[maybe_unused]] auto checks = sorter.sort(objective_values, ranks);
+        GA_COUNT_N(counters, DOMINANCE_CHECKS, checks);
+        for (size_t i = 0; i < pops.size(); i++)
+            pops[i].rank = ranks[i];
+        // stable, so each front keeps the order the population had
+        std::stable_sort(pops.begin(), pops.end(), [](const individual& a, const individual& b) { return a.rank < b.rank; });
+    }
+    
+    template<typename Objective>
     void program::keepElites(population& pop, size_t n)
     {
 //        constexpr bool useRank = false;
@@ -493,8 +1056,16 @@ namespace ga
 //                    pop.pops.push_back(current_population.pops[i]);
 //        } else
         // we are only going to keep one, but we have the option for more. At this point the population values are ordered so we can take the first
-        for (size_t i = 0; i < n && current_population.pops[i].rank == 1; i++)
-            pop.pops.push_back(current_population.pops[i]);
+        if constexpr (Objective::total_order)
+        {
+            // the best n are in order at the front after ranking
+            for (size_t i = 0; i < n && i < current_population.pops.size(); i++)
+                pop.pops.push_back(current_population.pops[i]);
+        } else
+        {
+            for (size_t i = 0; i < n && current_population.pops[i].rank == 1; i++)
+                pop.pops.push_back(current_population.pops[i]);
+        }
     }
     
     bool routes_same(const route& r1, const route& r2)
@@ -507,13 +1078,14 @@ namespace ga
         return true;
     }
     
+    template<typename Objective>
     void program::applyCrossover(population& pop)
     {
-        auto p1 = select_pop(TOURNAMENT_SIZE);
-        auto p2 = select_pop(TOURNAMENT_SIZE);
+        auto p1 = select_pop<Objective>(TOURNAMENT_SIZE);
+        auto p2 = select_pop<Objective>(TOURNAMENT_SIZE);
         // make sure we don't create children with ourselves
         while (p2 == p1)
-            p2 = select_pop(TOURNAMENT_SIZE);
+            p2 = select_pop<Objective>(TOURNAMENT_SIZE);
         
         const auto& parent1 = current_population.pops[p1];
         const auto& parent2 = current_population.pops[p2];
@@ -562,8 +1134,12 @@ namespace ga
                 {
                     auto& route = indv.routes[engine.getLong(0ul, indv.routes.size() - 1)];
                     if (route.customers.size() <= 1)
+                    {
+                        GA_COUNT(counters, MUTATION_RETRIES);
                         continue;
-                    auto route_copy = route;
+                    }
+                    // the mutation only reorders customers, so only they need saving
+                    std::pmr::vector<customerID_t> customers_copy(route.customers.begin(), route.customers.end(), scratch->resource());
                     if (route.customers.size() == 2)
                     {
                         // simple swap op.
@@ -582,7 +1158,7 @@ namespace ga
                     // if it's not valid, reset.
                     if (validate_route(route))
                     {
-                        route = route_copy;
+                        route.customers.assign(customers_copy.begin(), customers_copy.end());
                     }
                     
                     break;
@@ -645,41 +1221,46 @@ namespace ga
         }
     }
     
+    program program::evaluated_copy() const
+    {
+        program view(*this, SEED);
+        view.reconstruct_populations();
+        view.calculatePopulationFitness();
+        view.with_objective([&view](auto policy) { view.rankPopulation<decltype(policy)>(); });
+        return view;
+    }
+    
     void program::print()
     {
-        reconstruct_populations();
-        calculatePopulationFitness();
-        rankPopulation();
+        const auto view = evaluated_copy();
+        const auto& pops = view.current_population.pops;
         double averageDist = 0;
         size_t avgVeh = 0;
         for (int i = 0; i < POPULATION_SIZE; i++)
         {
-            BLT_DEBUG("\t(%d: %d | %f): Total Distance %f | Total Routes %d", i + 1, current_population.pops[i].rank,
-                      current_population.pops[i].fitness,
-                      current_population.pops[i].total_routes_distance,
-                      current_population.pops[i].routes.size());
-            averageDist += current_population.pops[i].total_routes_distance;
-            avgVeh += current_population.pops[i].routes.size();
+            BLT_DEBUG("\t(%d: %d | %f): Total Distance %f | Total Routes %d", i + 1, pops[i].rank, pops[i].fitness,
+                      pops[i].total_routes_distance, pops[i].routes.size());
+            averageDist += pops[i].total_routes_distance;
+            avgVeh += pops[i].routes.size();
         }
         BLT_INFO("Total/Avg Dist: (%f/%f), Total/Avg Routes: (%d/%d)", averageDist,
                  averageDist / static_cast<double>(POPULATION_SIZE), avgVeh, avgVeh / POPULATION_SIZE);
+        if (!hypervolume_history.empty())
+            BLT_INFO("Hypervolume of the last evaluated generation: %f", hypervolume_history.back());
+        BLT_INFO("Decodes skipped for clones: %d, clones replaced with immigrants: %d", clone_count, immigrant_count);
         int printed = 0;
-        if (using_fitness)
+        if (objective != objective_mode::PARETO)
         {
-            auto lowest = current_population.pops[0];
-            for (const auto& i : current_population.pops)
-            {
-                if (i.fitness < lowest.fitness)
-                    lowest = i;
-            }
+            // ranking put the best in front
+            const auto& lowest = pops[0];
             BLT_INFO("Best in population (%f): Total distance %f | Total Routes %d", lowest.fitness, lowest.total_routes_distance,
                      lowest.routes.size());
         } else
         {
-            for (int i = 0; i < POPULATION_SIZE && current_population.pops[i].rank == 1 && printed < 5; i++)
+            for (int i = 0; i < POPULATION_SIZE && pops[i].rank == 1 && printed < 5; i++)
             {
-                BLT_INFO("Best in population (%d): Total distance %f | Total Routes %d", printed, current_population.pops[i].total_routes_distance,
-                         current_population.pops[i].routes.size());
+                BLT_INFO("Best in population (%d): Total distance %f | Total Routes %d", printed, pops[i].total_routes_distance,
+                         pops[i].routes.size());
                 printed++;
             }
         }
@@ -687,21 +1268,21 @@ namespace ga
     
     void program::validate()
     {
-        reconstruct_populations();
-        rankPopulation();
+        auto view = evaluated_copy();
+        const auto& pops = view.current_population.pops;
         for (int i = 0; i < POPULATION_SIZE; i++)
         {
             std::string route_values;
-            for (size_t j = 0; j < current_population.pops[i].routes.size(); j++)
+            for (size_t j = 0; j < pops[i].routes.size(); j++)
             {
-                const auto& r = current_population.pops[i].routes[j];
-                if (validate_route(r))
+                const auto& r = pops[i].routes[j];
+                if (view.validate_route(r))
                 {
-                    route_values += std::to_string(calculate_distance(r)) += " ";
+                    route_values += std::to_string(view.calculate_distance(r)) += " ";
                 } else
                 {
                     BLT_ERROR("Failure in pop (%d), route (%d) is invalid!", i + 1, j + 1);
-                    constraintFailurePrint(r);
+                    view.constraintFailurePrint(r);
                 }
             }
         }
@@ -710,23 +1291,23 @@ namespace ga
     
     void program::write(const std::string& input)
     {
-        reconstruct_populations();
-        rankPopulation();
+        auto view = evaluated_copy();
+        const auto& pops = view.current_population.pops;
         const auto args = blt::string::split(input, ' ');
         std::string path = "./" + blt::system::getTimeStringFS();
         if (args.size() > 1)
             path = args[1];
         std::ofstream out(path);
-        for (size_t i = 0; i < current_population.pops.size(); i++)
+        for (size_t i = 0; i < pops.size(); i++)
         {
-            const auto& pop = current_population.pops[i];
+            const auto& pop = pops[i];
             out << '(' << i << ") " << pop.rank << " " << pop.fitness << ": " << pop.total_routes_distance << " | " << pop.routes.size() << "\n";
             out << "\troutes:\n";
             for (const auto& r : pop.routes)
             {
                 if (r.total_distance == 0)
-                    BLT_WARN("We have a zero distance! %f", calculate_distance(r));
-                out << "\t\t" << r.total_distance << "(valid? " << (validate_route(r) ? "true" : "false")
+                    BLT_WARN("We have a zero distance! %f", view.calculate_distance(r));
+                out << "\t\t" << r.total_distance << "(valid? " << (view.validate_route(r) ? "true" : "false")
                     << "): ";
                 for (const auto c : r.customers)
                     out << c << " ";
@@ -760,6 +1341,43 @@ namespace ga
         avg_file += blt::system::getTimeStringFS();
         avg_file += ".csv";
         write_history(avg_file, avg_history);
+        
+        std::string hypervolume_file{"./ga_hypervolume_history_"};
+        hypervolume_file += blt::system::getTimeStringFS();
+        hypervolume_file += ".csv";
+        std::ofstream hypervolume_out(hypervolume_file);
+        hypervolume_out << "Generation,Hypervolume\n";
+        for (size_t i = 0; i < hypervolume_history.size(); i++)
+            hypervolume_out << i + 1 << ',' << hypervolume_history[i] << '\n';
+        
+        std::string anytime_file{"./ga_anytime_"};
+        anytime_file += blt::system::getTimeStringFS();
+        anytime_file += ".csv";
+        std::ofstream anytime_out(anytime_file);
+        anytime_out << "Seconds,Evaluations,BestVehicles,BestVehiclesDistance,BestDistance,Hypervolume\n";
+        for (const auto& v : anytime_trace)
+            anytime_out << v.seconds << ',' << v.evaluations << ',' << v.vehicles << ',' << v.vehicles_distance << ',' << v.distance << ',' << v.hypervolume << '\n';
+        
+        std::string population_file{"./ga_population_history_"};
+        population_file += blt::system::getTimeStringFS();
+        population_file += ".csv";
+        std::ofstream population_out(population_file);
+        generation_data.write_csv(population_out);
+        
+        std::string arena_file{"./ga_arena_"};
+        arena_file += blt::system::getTimeStringFS();
+        arena_file += ".csv";
+        std::ofstream arena_out(arena_file);
+        writeArenaCSV(arena_out, arena_history);
+        
+        if constexpr (COUNTERS_ENABLED)
+        {
+            std::string counter_file{"./ga_counters_"};
+            counter_file += blt::system::getTimeStringFS();
+            counter_file += ".csv";
+            std::ofstream out(counter_file);
+            counters.writeCSV(out, count, static_cast<double>(profile.total()) / 1e9);
+        }
     }
     
     void program::calculatePopulationFitness()
@@ -770,6 +1388,10 @@ namespace ga
     
     void program::reset()
     {
+        // the new population is decoded and ranked from scratch on the next step, nothing of the old one may be reused
+        steady_state_ready = false;
+        population_evaluated = false;
+        previous_population.pops.clear();
         current_population.pops.clear();
         for (int i = 0; i < POPULATION_SIZE; i++)
             current_population.pops.emplace_back(createRandomChromosome());
@@ -812,4 +1434,25 @@ namespace ga
         }
     }
     
+    // every policy is instantiated here, the kernel benchmarks time selection and ranking from outside this file
+    template customerID_t program::select_pop<pareto_objective>(size_t);
+    template customerID_t program::select_pop<weighted_sum_objective>(size_t);
+    template customerID_t program::select_pop<lexicographic_objective>(size_t);
+    template void program::rankPopulation<pareto_objective>();
+    template void program::rankPopulation<weighted_sum_objective>();
+    template void program::rankPopulation<lexicographic_objective>();
+    // the async runner drives the steady state pieces from its own threads
+    template void program::prepare_steady_state<pareto_objective>();
+    template void program::prepare_steady_state<weighted_sum_objective>();
+    template void program::prepare_steady_state<lexicographic_objective>();
+    template void program::breed_offspring<pareto_objective>(population&);
+    template void program::breed_offspring<weighted_sum_objective>(population&);
+    template void program::breed_offspring<lexicographic_objective>(population&);
+    template void program::insert_offspring<pareto_objective>(individual&&);
+    template void program::insert_offspring<weighted_sum_objective>(individual&&);
+    template void program::insert_offspring<lexicographic_objective>(individual&&);
+    template void program::finish_steady_state_generation<pareto_objective>();
+    template void program::finish_steady_state_generation<weighted_sum_objective>();
+    template void program::finish_steady_state_generation<lexicographic_objective>();
+    
 }
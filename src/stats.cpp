@@ -0,0 +1,139 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <stats.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ga
+{
+
+    double t_critical(double df)
+    {
+        static constexpr std::array<double, 30> table{
+                12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+                2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+        auto i = static_cast<size_t>(std::max(1.0, std::floor(df)));
+        return i <= table.size() ? table[i - 1] : 1.96;
+    }
+
+    p2_quantile::p2_quantile(double p): p(p)
+    {
+        desired = {1, 1 + 2 * p, 1 + 4 * p, 3 + 2 * p, 5};
+        increment = {0, p / 2, p, (1 + p) / 2, 1};
+        pos = {1, 2, 3, 4, 5};
+    }
+
+    void p2_quantile::add(double x)
+    {
+        if (n < q.size())
+        {
+            q[n++] = x;
+            if (n == q.size())
+                std::sort(q.begin(), q.end());
+            return;
+        }
+        n++;
+
+        size_t k;
+        if (x < q[0])
+        {
+            q[0] = x;
+            k = 0;
+        } else if (x >= q[4])
+        {
+            q[4] = x;
+            k = 3;
+        } else
+        {
+            k = 0;
+            while (x >= q[k + 1])
+                k++;
+        }
+        for (size_t i = k + 1; i < pos.size(); i++)
+            pos[i]++;
+        for (size_t i = 0; i < desired.size(); i++)
+            desired[i] += increment[i];
+
+        // move the middle markers towards their desired positions, piecewise parabolic where that keeps them ordered
+        for (size_t i = 1; i < 4; i++)
+        {
+            auto d = desired[i] - pos[i];
+            if ((d >= 1 && pos[i + 1] - pos[i] > 1) || (d <= -1 && pos[i - 1] - pos[i] < -1))
+            {
+                double s = d >= 0 ? 1 : -1;
+                auto parabolic = q[i] + s / (pos[i + 1] - pos[i - 1]) * ((pos[i] - pos[i - 1] + s) * (q[i + 1] - q[i]) / (pos[i + 1] - pos[i]) +
+                                                                          (pos[i + 1] - pos[i] - s) * (q[i] - q[i - 1]) / (pos[i] - pos[i - 1]));
+                if (q[i - 1] < parabolic && parabolic < q[i + 1])
+                    q[i] = parabolic;
+                else
+                {
+                    auto j = s > 0 ? i + 1 : i - 1;
+                    q[i] += s * (q[j] - q[i]) / (pos[j] - pos[i]);
+                }
+                pos[i] += s;
+            }
+        }
+    }
+
+    double p2_quantile::value() const
+    {
+        if (n == 0)
+            return 0;
+        if (n >= q.size())
+            return q[2];
+        auto sorted = q;
+        std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(n));
+        auto index = p * static_cast<double>(n - 1);
+        auto below = static_cast<size_t>(std::floor(index));
+        auto above = std::min(below + 1, n - 1);
+        return sorted[below] + (sorted[above] - sorted[below]) * (index - static_cast<double>(below));
+    }
+
+    void running_stats::add(double x)
+    {
+        n++;
+        auto delta = x - m;
+        m += delta / static_cast<double>(n);
+        m2 += delta * (x - m);
+        lo = std::min(lo, x);
+        hi = std::max(hi, x);
+        q10.add(x);
+        q50.add(x);
+        q90.add(x);
+    }
+
+    double running_stats::stddev() const
+    {
+        return std::sqrt(variance());
+    }
+
+    double running_stats::ci_half_width() const
+    {
+        if (n < 2)
+            return std::numeric_limits<double>::infinity();
+        return t_critical(static_cast<double>(n - 1)) * stddev() / std::sqrt(static_cast<double>(n));
+    }
+
+    double running_stats::relative_ci() const
+    {
+        auto width = ci_half_width();
+        if (width == 0)
+            return 0;
+        return m == 0 ? std::numeric_limits<double>::infinity() : width / std::abs(m);
+    }
+
+    void running_stats::writeCSVHeader(std::ostream& out)
+    {
+        out << "Label,Objective,Runs,Mean,StdDev,CI95,Min,P10,Median,P90,Max\n";
+    }
+
+    void running_stats::writeCSV(std::ostream& out, const std::string& label, const std::string& name) const
+    {
+        out << label << ',' << name << ',' << n << ',' << m << ',' << stddev() << ',' << (n < 2 ? 0 : ci_half_width()) << ',' << lo << ','
+            << p10() << ',' << median() << ',' << p90() << ',' << hi << '\n';
+    }
+
+}
@@ -0,0 +1,145 @@
+/*
+ * Licensed under GNU General Public License V3.0
+ * See LICENSE file for license detail
+ */
+#include <trace.h>
+#include <blt/std/logging.h>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ga::trace
+{
+    namespace detail
+    {
+        std::atomic_bool active = false;
+    }
+
+    struct event
+    {
+        std::int64_t start_ns;
+        std::int64_t end_ns;
+        std::uint32_t name;
+        const char* category;
+    };
+
+    struct thread_buffer
+    {
+        std::uint32_t tid;
+        std::string thread_name;
+        // a deque grows in blocks, so a long batch never pays for copying the whole timeline
+        std::deque<event> events;
+        // names are interned per thread so recording stays lock free
+        std::vector<std::string> names;
+        std::unordered_map<std::string, std::uint32_t> name_ids;
+
+        std::uint32_t intern(const std::string& name)
+        {
+            auto it = name_ids.find(name);
+            if (it != name_ids.end())
+                return it->second;
+            auto id = static_cast<std::uint32_t>(names.size());
+            names.push_back(name);
+            name_ids.insert({name, id});
+            return id;
+        }
+    };
+
+    static std::mutex registry_lock;
+    static std::vector<std::unique_ptr<thread_buffer>> buffers;
+    static std::string output_path;
+    static clock::time_point epoch;
+
+    static thread_buffer& local_buffer()
+    {
+        // only the first span on a thread takes the lock, the buffer outlives the thread so flush can still read it
+        static thread_local thread_buffer* buffer = nullptr;
+        if (buffer == nullptr)
+        {
+            std::scoped_lock lock(registry_lock);
+            buffers.push_back(std::make_unique<thread_buffer>());
+            buffer = buffers.back().get();
+            buffer->tid = static_cast<std::uint32_t>(buffers.size());
+        }
+        return *buffer;
+    }
+
+    void enable(const std::string& path)
+    {
+        {
+            std::scoped_lock lock(registry_lock);
+            output_path = path;
+            epoch = clock::now();
+        }
+        if (!detail::active.exchange(true))
+            std::atexit(flush);
+    }
+
+    void set_thread_name(const std::string& name)
+    {
+        if (enabled())
+            local_buffer().thread_name = name;
+    }
+
+    void record(const std::string& name, const char* category, clock::time_point start, clock::time_point end)
+    {
+        auto& buffer = local_buffer();
+        buffer.events.push_back({std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count(),
+                                 std::chrono::duration_cast<std::chrono::nanoseconds>(end - epoch).count(), buffer.intern(name), category});
+    }
+
+    static void write_escaped(std::ostream& out, const std::string& str)
+    {
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+    }
+
+    void flush()
+    {
+        if (!enabled())
+            return;
+        std::scoped_lock lock(registry_lock);
+        std::ofstream out(output_path);
+        if (!out)
+        {
+            BLT_ERROR("Unable to write trace to %s", output_path.c_str());
+            return;
+        }
+        size_t written = 0;
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (const auto& buffer : buffers)
+        {
+            if (!buffer->thread_name.empty())
+            {
+                out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":\"";
+                write_escaped(out, buffer->thread_name);
+                out << "\"}}";
+                first = false;
+            }
+            for (const auto& e : buffer->events)
+            {
+                // trace-event timestamps are in microseconds
+                out << (first ? "" : ",") << "\n{\"name\":\"";
+                write_escaped(out, buffer->names[e.name]);
+                out << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":"
+                    << static_cast<double>(e.start_ns) / 1e3 << ",\"dur\":" << static_cast<double>(e.end_ns - e.start_ns) / 1e3 << "}";
+                first = false;
+                written++;
+            }
+        }
+        out << "\n]}\n";
+        BLT_INFO("Wrote %d trace events to %s", written, output_path.c_str());
+    }
+}